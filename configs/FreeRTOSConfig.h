@@ -87,7 +87,12 @@
 #define configUSE_RECURSIVE_MUTEXES             1
 #define configUSE_COUNTING_SEMAPHORES           1
 #define configQUEUE_REGISTRY_SIZE               10
+/* Queue sets drive the event loop task of the APP_EVENT_LOOP_ENABLED build */
+#if defined(APP_EVENT_LOOP_ENABLED) && (APP_EVENT_LOOP_ENABLED != 0)
+#define configUSE_QUEUE_SETS                    1
+#else
 #define configUSE_QUEUE_SETS                    0
+#endif
 #define configUSE_TIME_SLICING                  1
 #define configENABLE_BACKWARD_COMPATIBILITY     0
 #define configNUM_THREAD_LOCAL_STORAGE_POINTERS 16
@@ -174,7 +179,7 @@ to exclude the API function. */
 #define INCLUDE_vTaskDelay                      1
 #define INCLUDE_xTaskGetSchedulerState          1
 #define INCLUDE_xTaskGetCurrentTaskHandle       1
-#define INCLUDE_uxTaskGetStackHighWaterMark     0
+#define INCLUDE_uxTaskGetStackHighWaterMark     1
 #define INCLUDE_xTaskGetIdleTaskHandle          0
 #define INCLUDE_eTaskGetState                   0
 #define INCLUDE_xEventGroupSetBitFromISR        1
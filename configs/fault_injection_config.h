@@ -0,0 +1,71 @@
+/******************************************************************************
+ * File Name: fault_injection_config.h
+ *
+ * Description: This file contains the configuration macros and the scenario
+ *              of the network fault injection.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef FAULT_INJECTION_CONFIG_H_
+#define FAULT_INJECTION_CONFIG_H_
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Set this macro to 1 to run the fault injection scenario after the first
+ * MQTT connection. Only use it for testing, the scenario disconnects the
+ * device on purpose.
+ */
+#ifndef FAULT_INJECTION_ENABLED
+#define FAULT_INJECTION_ENABLED                 (0)
+#endif
+
+/* Time in milliseconds between the first MQTT connection and the first step
+ * of the scenario, and between the end of a step and the next step.
+ */
+#define FAULT_INJECTION_START_DELAY_MS          (60u * 1000u)
+#define FAULT_INJECTION_STEP_INTERVAL_MS        (120u * 1000u)
+
+/* Time in milliseconds to wait for the reconnection after a disconnecting
+ * fault. Steps that do not recover within this time report a timeout.
+ */
+#define FAULT_INJECTION_RECONNECT_TIMEOUT_MS    (15u * 60u * 1000u)
+
+/* Share of the publishes dropped and delay added to each publish by the
+ * publish loss and publish latency faults.
+ */
+#define FAULT_INJECTION_PUBLISH_LOSS_PERCENT    (30u)
+#define FAULT_INJECTION_PUBLISH_LATENCY_MS      (2000u)
+
+/* Scenario as a list of { fault, duration in milliseconds } steps. The
+ * duration is ignored by the Wi-Fi and MQTT drops and the connect race,
+ * which last until the device reconnected.
+ */
+#define FAULT_INJECTION_SCENARIO                                \
+    { FAULT_WIFI_DROP,       0u },                              \
+    { FAULT_MQTT_DROP,       0u },                              \
+    { FAULT_CONNECT_RACE,    0u },                              \
+    { FAULT_BROKER_DOWN,     (30u * 1000u) },                   \
+    { FAULT_PUBLISH_LOSS,    (120u * 1000u) },                  \
+    { FAULT_PUBLISH_LATENCY, (120u * 1000u) }
+
+#endif /* FAULT_INJECTION_CONFIG_H_ */
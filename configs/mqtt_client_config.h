@@ -36,6 +36,19 @@
 #define MQTT_BROKER_ADDRESS               "MY_AWS_IOT_ENDPOINT_ADDRESS"
 #define MQTT_PORT                         8883
 
+/* Additional MQTT brokers to fail over to, as a comma separated list of
+ * { hostname, port, priority } entries. The broker above has priority 0 and
+ * lower values are preferred. Each connect attempt picks the broker with the
+ * best score from its priority, its measured connect latency and its recent
+ * failures, see broker_select.c. All brokers share the credentials below.
+ * The hostname of a broker is sent in the SNI and verified against its
+ * certificate; a broker connected by its IP address, or one whose
+ * certificate is issued for another name, takes that name as a fourth entry.
+ *
+ * Example: { "backup.example.com", 8883, 1 }, { "192.168.1.10", 8883, 2, "backup.example.com" }
+ */
+#define MQTT_BROKER_FALLBACKS
+
 /* Set this macro to 1 if a secure (TLS) connection to the MQTT Broker is
  * required to be established, else 0.
  */
@@ -46,10 +59,49 @@
 #define MQTT_PASSWORD                     ""
 
 /********************* MQTT MESSAGE CONFIGURATION MACROS **********************/
-/* The MQTT topics for Publisher and Subscriber. */
+/* The MQTT topics for Publisher and Subscriber. All topics, including the
+ * alert, diagnostics, configuration reply and will topics, are templates
+ * that may contain the placeholders '{client_id}' and '{device_id}', e.g.
+ * "site/{device_id}/co2", to give each device its own topic namespace.
+ * '{client_id}' is the client identifier of the MQTT connection, it changes
+ * on each connection if 'GENERATE_UNIQUE_CLIENT_ID' is set.
+ * '{device_id}' is the unique die ID of the device in 16 hex digits, which
+ * never changes. The templates are expanded before each connection in which
+ * the client identifier changed. A template that can expand to more than 63
+ * characters, counting 31 for '{client_id}', stops the application at start.
+ */
 #define MQTT_PUB_TOPIC                        "pasco2_status"
 #define MQTT_SUB_TOPIC                        "pasco2_config"
 
+/* The MQTT topic and QoS of the alert events raised by the CO2 analytics.
+ * Alerts are rare and must not be lost, so they are published with QoS 1
+ * even if 'MQTT_MESSAGES_QOS' is lowered for the routine telemetry.
+ */
+#define MQTT_ALERT_TOPIC                      "pasco2_alert"
+#define MQTT_ALERT_QOS                        ( 1 )
+
+/* The MQTT topic and QoS of the device diagnostics, e.g. the time breakdown
+ * of each connection setup.
+ */
+#define MQTT_DIAG_TOPIC                       "pasco2_diag"
+#define MQTT_DIAG_QOS                         ( 0 )
+
+/* The MQTT topic and QoS of the replies to the configuration messages. */
+#define MQTT_CONFIG_ACK_TOPIC                 "pasco2_config_ack"
+#define MQTT_CONFIG_ACK_QOS                   ( 1 )
+
+/* The QoS of the routine telemetry on 'MQTT_PUB_TOPIC'. With QoS 0 a publish
+ * does not wait for the PUBACK, but a sample lost with the connection is
+ * neither detected nor redelivered.
+ */
+#define MQTT_TELEMETRY_QOS                    ( MQTT_MESSAGES_QOS )
+
+/* Shortest time in milliseconds between two messages published from the
+ * redelivery ring after a reconnection. The held samples of a whole fleet
+ * reach a restarted broker at this rate instead of all at once.
+ */
+#define MQTT_PUB_FLUSH_INTERVAL_MS            ( 200u )
+
 /* Set the QoS that is associated with the MQTT publish, and subscribe messages.
  * Valid choices are 0, 1, and 2. Other values should not be used in this macro.
  */
@@ -133,11 +185,13 @@
  */
 #define MQTT_NETWORK_BUFFER_SIZE          ( 2 * CY_MQTT_MIN_NETWORK_BUFFER_SIZE )
 
-/* Maximum MQTT connection re-connection limit. */
-#define MAX_MQTT_CONN_RETRIES            (150u)
-
-/* MQTT re-connection time interval in milliseconds. */
+/* Shortest and longest MQTT re-connection time interval in milliseconds.
+ * The interval grows with random jitter between these limits, so that a
+ * fleet of devices does not reconnect in lockstep after a broker restart.
+ * The connection is retried until it succeeds.
+ */
 #define MQTT_CONN_RETRY_INTERVAL_MS      (2000)
+#define MQTT_CONN_RETRY_MAX_INTERVAL_MS  (60000)
 
 
 /**************** MQTT CLIENT CERTIFICATE CONFIGURATION MACROS ****************/
@@ -161,9 +215,23 @@
 "........base64 data........\n" \
 "-----END CERTIFICATE-----"
 
+/******************************************************************************
+* Typedefines
+*******************************************************************************/
+/* MQTT broker the client can connect to */
+typedef struct
+{
+    const char *hostname;
+    uint16_t port;
+    uint8_t priority;
+    const char *sni_hostname;   /* SNI and certificate name, NULL for 'hostname' */
+} mqtt_broker_endpoint_t;
+
 /******************************************************************************
 * Global Variables
 *******************************************************************************/
+extern const mqtt_broker_endpoint_t broker_endpoints[];
+extern const uint32_t broker_endpoint_count;
 extern cy_mqtt_broker_info_t broker_info;
 extern cy_awsport_ssl_credentials_t  *security_info;
 extern cy_mqtt_connect_info_t connection_info;
@@ -0,0 +1,64 @@
+/******************************************************************************
+ * File Name: stack_size_config.h
+ *
+ * Description: This file contains the configuration of the stack size
+ *              calibration and the calibrated task stack sizes.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef STACK_SIZE_CONFIG_H_
+#define STACK_SIZE_CONFIG_H_
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Set this macro to 1 (or build with STACK_CALIBRATION=1) to drive the
+ * worst-case paths of the application after the first MQTT connection and
+ * print the stack sizes they need. Only use it for calibration, the device
+ * reconnects to the broker on purpose.
+ */
+#ifndef STACK_CALIBRATION_ENABLED
+#define STACK_CALIBRATION_ENABLED               (0)
+#endif
+
+/* Time in milliseconds between the first MQTT connection and the first
+ * worst-case path, and between the stack size reports. The reports go on
+ * while the device runs, so that paths taken later are also measured.
+ */
+#define STACK_CALIBRATION_START_DELAY_MS        (30u * 1000u)
+#define STACK_CALIBRATION_REPORT_INTERVAL_MS    (10u * 60u * 1000u)
+
+/* Time in milliseconds to wait for the reconnection to the broker */
+#define STACK_CALIBRATION_RECONNECT_TIMEOUT_MS  (5u * 60u * 1000u)
+
+/* Margin added to the measured stack use, and the granularity in words the
+ * calibrated sizes are rounded up to.
+ */
+#define STACK_CALIBRATION_MARGIN_PERCENT        (25u)
+#define STACK_CALIBRATION_ROUND_WORDS           (64u)
+
+/* Calibrated stack sizes in words. Replace this section with the block
+ * printed by the calibration build. A task without a size here uses the
+ * default of its header.
+ */
+
+#endif /* STACK_SIZE_CONFIG_H_ */
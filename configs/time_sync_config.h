@@ -0,0 +1,55 @@
+/******************************************************************************
+ * File Name: time_sync_config.h
+ *
+ * Description: This file contains the configuration macros required for the
+ *              SNTP time synchronization.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef TIME_SYNC_CONFIG_H_
+#define TIME_SYNC_CONFIG_H_
+
+/*******************************************************************************
+* Macros
+********************************************************************************/
+/* Hostname and UDP port of the SNTP server. */
+#define SNTP_SERVER_ADDRESS               "pool.ntp.org"
+#define SNTP_SERVER_PORT                  (123u)
+
+/* Time in milliseconds to wait for the SNTP server response. */
+#define SNTP_RESPONSE_TIMEOUT_MS          (3000u)
+
+/* Interval in milliseconds between two time synchronizations. */
+#define TIME_SYNC_INTERVAL_MS             (60u * 60u * 1000u)
+
+/* Interval in milliseconds between synchronization attempts while the time
+ * was never synchronized.
+ */
+#define TIME_SYNC_RETRY_INTERVAL_MS       (60u * 1000u)
+
+/* Limit of the clock drift correction in parts per million. The PSoC 6
+ * clock source is well within this range, larger values indicate a bad
+ * SNTP response.
+ */
+#define TIME_SYNC_MAX_DRIFT_PPM           (500)
+
+#endif /* TIME_SYNC_CONFIG_H_ */
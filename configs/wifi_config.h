@@ -44,10 +44,25 @@
  */
 #define WIFI_SECURITY                     CY_WCM_SECURITY_WPA2_AES_PSK
 
-/* Maximum Wi-Fi re-connection limit. */
-#define MAX_WIFI_CONN_RETRIES             (120u)
-
-/* Wi-Fi re-connection time interval in milliseconds. */
+/* Shortest and longest Wi-Fi re-connection time interval in milliseconds.
+ * The interval grows with random jitter between these limits, and the
+ * connection is retried until it succeeds.
+ */
 #define WIFI_CONN_RETRY_INTERVAL_MS       (5000)
+#define WIFI_CONN_RETRY_MAX_INTERVAL_MS   (60000)
+
+/* Set this macro to 1 to rejoin the last Wi-Fi AP directly by its BSSID
+ * instead of searching the SSID on all channels. The full connect is used
+ * if the rejoin fails.
+ */
+#define WIFI_FAST_REJOIN_ENABLED          (1)
+
+/* Set this macro to 1 to also reuse the last DHCP lease on a rejoin, which
+ * skips the DHCP exchange. The address is then used without renewing the
+ * lease, so only enable this if the DHCP server reserves the address for the
+ * device. A lease older than the maximum age below is not reused.
+ */
+#define WIFI_FAST_REJOIN_REUSE_LEASE      (0)
+#define WIFI_FAST_REJOIN_LEASE_MAX_AGE_MS (60u * 60u * 1000u)
 
 #endif /* WIFI_CONFIG_H_ */
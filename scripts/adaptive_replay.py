@@ -0,0 +1,196 @@
+#!/usr/bin/env python3
+"""
+File Name:   adaptive_replay.py
+
+Description: Host tool that runs the adaptive sampling scheduler of
+             source/pasco2_adaptive.c on a recorded sensor trace and
+             compares it with a fixed measurement period. The trace is read
+             from the array of source/sensor_trace_data.c or from a binary
+             dump of the recorder. Between two records the CO2 value is
+             interpolated linearly. For both schedules the tool reports the
+             number of samples and, once per second, how far the last
+             sampled value is from the interpolated trace, i.e. the tracking
+             error of the published data.
+
+             The thresholds and the period limits are read from
+             source/pasco2_adaptive.h.
+
+             Usage: adaptive_replay.py [--trace trace.bin] [--period 60]
+
+Related Document: See README.md
+
+===========================================================================
+Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+===========================================================================
+
+===========================================================================
+Infineon Technologies AG (INFINEON) is supplying this file for use
+exclusively with Infineon's sensor products. This file can be freely
+distributed within development tools and software supporting such
+products.
+
+THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+WHATSOEVER.
+===========================================================================
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+# Root of the application, the header and the trace are read from its source tree
+APP_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+ADAPTIVE_HEADER = "source/pasco2_adaptive.h"
+TRACE_SOURCE = "source/sensor_trace_data.c"
+
+DEFINE_RE = re.compile(r"^\s*#\s*define\s+(PASCO2_ADAPTIVE_\w+)\s+\(?\s*(\d+)[uU]?\s*\)?\s*$")
+HEX_BYTE_RE = re.compile(r"0x([0-9a-fA-F]{2})")
+
+# Layout of sensor_trace_record_t, see source/sensor_trace.h
+RECORD = struct.Struct("<IHHhBB")
+
+# Fixed-point scale and filter weight of the slope, see source/pasco2_adaptive.c
+SLOPE_SCALE_SHIFT = 4
+SLOPE_FILTER_SHIFT = 2
+
+
+def read_limits(root):
+    """Returns the integer macros of the adaptive scheduler header."""
+    limits = {}
+    with open(os.path.join(root, ADAPTIVE_HEADER), "r") as header_file:
+        for line in header_file:
+            match = DEFINE_RE.match(line)
+            if match:
+                limits[match.group(1)] = int(match.group(2))
+    return limits
+
+
+def read_trace(path):
+    """Returns the (time_ms, ppm) pairs of the successful reads of a trace."""
+    if path.endswith(".c"):
+        with open(path, "r") as source_file:
+            source = source_file.read()
+        data = bytes(int(value, 16) for value in HEX_BYTE_RE.findall(source[source.index("{"):]))
+    else:
+        with open(path, "rb") as trace_file:
+            data = trace_file.read()
+
+    trace = []
+    for offset in range(0, len(data) - RECORD.size + 1, RECORD.size):
+        time_ms, ppm, _, _, _, result = RECORD.unpack_from(data, offset)
+        if result == 0:
+            trace.append((time_ms, ppm))
+    return trace
+
+
+def c_div(numerator, denominator):
+    """Integer division truncating towards zero like C."""
+    quotient = abs(numerator) // abs(denominator)
+    return quotient if (numerator >= 0) == (denominator >= 0) else -quotient
+
+
+class Adaptive:
+    """Port of pasco2_adaptive_init() and pasco2_adaptive_update()."""
+
+    def __init__(self, limits, period_s):
+        self.limits = limits
+        self.period_s = min(max(period_s, limits["PASCO2_ADAPTIVE_PERIOD_MIN_S"]),
+                            limits["PASCO2_ADAPTIVE_PERIOD_MAX_S"])
+        self.slope_x16 = 0
+        self.calm_count = 0
+        self.last = None
+
+    def update(self, ppm, now_ms):
+        limits = self.limits
+        if self.last is not None and now_ms > self.last[1]:
+            delta_ppm = ppm - self.last[0]
+            elapsed_ms = now_ms - self.last[1]
+            slope_x16 = c_div(delta_ppm * 60000 * (1 << SLOPE_SCALE_SHIFT), elapsed_ms)
+            self.slope_x16 += c_div(slope_x16 - self.slope_x16, 1 << SLOPE_FILTER_SHIFT)
+
+            abs_slope_x16 = abs(self.slope_x16)
+            if abs_slope_x16 >= limits["PASCO2_ADAPTIVE_RISE_PPM_PER_MIN"] << SLOPE_SCALE_SHIFT:
+                self.calm_count = 0
+                self.period_s = max(self.period_s // 2, limits["PASCO2_ADAPTIVE_PERIOD_MIN_S"])
+            elif abs_slope_x16 <= limits["PASCO2_ADAPTIVE_CALM_PPM_PER_MIN"] << SLOPE_SCALE_SHIFT:
+                self.calm_count += 1
+                if self.calm_count >= limits["PASCO2_ADAPTIVE_CALM_SAMPLES"]:
+                    self.calm_count = 0
+                    self.period_s = min(self.period_s * 2, limits["PASCO2_ADAPTIVE_PERIOD_MAX_S"])
+            else:
+                self.calm_count = 0
+
+        self.last = (ppm, now_ms)
+        return self.period_s
+
+
+def value_at(trace, index, time_ms):
+    """Returns the CO2 value at a time, interpolated between two records.
+    'index' is the last record at or before the time."""
+    if index + 1 >= len(trace):
+        return trace[-1][1]
+    (t0, v0), (t1, v1) = trace[index], trace[index + 1]
+    return v0 + c_div((v1 - v0) * (time_ms - t0), t1 - t0)
+
+
+def run(trace, next_period_s):
+    """Samples the trace with a period chosen after each sample and returns
+    the sample count and the tracking error of every second."""
+    samples = 0
+    errors = []
+    held = None
+    next_ms = trace[0][0]
+    index = 0
+    for time_ms in range(trace[0][0], trace[-1][0] + 1, 1000):
+        while index + 1 < len(trace) and trace[index + 1][0] <= time_ms:
+            index += 1
+        value = value_at(trace, index, time_ms)
+        if time_ms >= next_ms:
+            held = value
+            samples += 1
+            next_ms = time_ms + next_period_s(held, time_ms) * 1000
+        errors.append(abs(value - held))
+    return samples, errors
+
+
+def report(name, samples, errors):
+    errors_sorted = sorted(errors)
+    p95 = errors_sorted[min(len(errors_sorted) - 1, (len(errors_sorted) * 95) // 100)]
+    print("%-10s %8d %10.1f %8d %8d" % (name, samples, sum(errors) / len(errors), p95, errors_sorted[-1]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compares adaptive and fixed sampling on a recorded trace")
+    parser.add_argument("--trace", default=os.path.join(APP_ROOT, TRACE_SOURCE),
+                        help="binary trace dump or C source with the trace array")
+    parser.add_argument("--period", type=int, default=60,
+                        help="fixed measurement period and start period of the adaptive scheduler in seconds")
+    args = parser.parse_args()
+
+    limits = read_limits(APP_ROOT)
+    trace = read_trace(args.trace)
+    if len(trace) < 2:
+        print("The trace has fewer than two successful reads")
+        return 1
+
+    adaptive = Adaptive(limits, args.period)
+    adaptive_samples, adaptive_errors = run(trace, adaptive.update)
+    fixed_samples, fixed_errors = run(trace, lambda ppm, now_ms: args.period)
+
+    print("%d records over %d s, fixed period %d s" %
+          (len(trace), (trace[-1][0] - trace[0][0]) // 1000, args.period))
+    print("%-10s %8s %10s %8s %8s" % ("schedule", "samples", "err avg", "err p95", "err max"))
+    report("fixed", fixed_samples, fixed_errors)
+    report("adaptive", adaptive_samples, adaptive_errors)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
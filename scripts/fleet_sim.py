@@ -0,0 +1,805 @@
+#!/usr/bin/env python3
+"""
+File Name:   fleet_sim.py
+
+Description: Host load generator that runs a fleet of virtual PAS CO2
+             devices against an MQTT broker in one process. Each device has
+             its own client identifier, the synthetic CO2 source of
+             source/co2_synthetic.c, a publish period with random jitter, a
+             publisher with the redelivery ring and flush rate of the
+             firmware, and a subscriber for the configuration topic. The
+             reconnections use the backoff of source/backoff.c.
+
+             The constants of the model, the topics and the timings are read
+             from the firmware headers, so the fleet behaves like boards built
+             from the same tree. The simulator reports the acknowledged
+             publishes per second, the PUBACK latency distribution, and the
+             reconnection attempts, and flags the intervals in which a large
+             part of the fleet reconnects at once (a reconnect storm).
+
+             Usage: fleet_sim.py --devices 1000 --broker localhost
+                    fleet_sim.py -h for all options
+
+Related Document: See README.md
+
+===========================================================================
+Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+===========================================================================
+
+===========================================================================
+Infineon Technologies AG (INFINEON) is supplying this file for use
+exclusively with Infineon's sensor products. This file can be freely
+distributed within development tools and software supporting such
+products.
+
+THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+WHATSOEVER.
+===========================================================================
+"""
+
+import argparse
+import asyncio
+import collections
+import json
+import os
+import random
+import re
+import ssl
+import struct
+import sys
+import time
+
+# Root of the application, the headers are read from its source tree
+APP_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+HEADERS = (
+    "source/co2_synthetic.h",
+    "source/pasco2_task.h",
+    "source/publish_retry.h",
+    "source/publisher_task.h",
+    "configs/mqtt_client_config.h",
+)
+
+DEFINE_RE = re.compile(r"^\s*#\s*define\s+([A-Za-z_]\w*)\s+(.+?)\s*(?://.*)?$")
+INT_SUFFIX_RE = re.compile(r"\b(0[xX][0-9a-fA-F]+|\d+)[uUlL]+\b")
+NAME_RE = re.compile(r"\b[A-Za-z_]\w*\b")
+ARITHMETIC_RE = re.compile(r"^[0-9xXa-fA-F\s()+\-*/<>]+$")
+
+# xorshift32 of source/prng.c
+PRNG_MASK = 0xFFFFFFFF
+PRNG_DEFAULT_SEED = 0x9E3779B9
+
+# Growth factor of the reconnection backoff, see source/backoff.c
+BACKOFF_GROWTH_FACTOR = 3
+
+# Fixed-point scale of the room level, see source/co2_synthetic.c
+LEVEL_SCALE_SHIFT = 4
+CO2_SYNTHETIC_MAX_PPM = 32000
+
+# Valid range of the measurement period, see xensiv_pasco2.h
+MEAS_RATE_MIN_S = 10
+MEAS_RATE_MAX_S = 4095
+
+# MQTT 3.1.1 control packet types
+MQTT_CONNECT = 0x10
+MQTT_CONNACK = 0x20
+MQTT_PUBLISH = 0x30
+MQTT_PUBACK = 0x40
+MQTT_SUBSCRIBE = 0x82
+MQTT_SUBACK = 0x90
+MQTT_PINGREQ = 0xC0
+MQTT_PINGRESP = 0xD0
+MQTT_DISCONNECT = 0xE0
+
+# Upper bounds of the PUBACK latency histogram in milliseconds
+LATENCY_BUCKETS_MS = (5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000)
+
+
+def read_defines(root):
+    """Returns the raw values of the macros of the firmware headers."""
+    defines = {}
+    for header in HEADERS:
+        with open(os.path.join(root, header), "r") as header_file:
+            for line in header_file:
+                match = DEFINE_RE.match(line)
+                if match and match.group(1) not in defines:
+                    defines[match.group(1)] = match.group(2)
+    return defines
+
+
+def define_value(defines, name, depth=0):
+    """Returns the value of an integer or string macro."""
+    value = defines[name].strip()
+    if value.startswith('"'):
+        return value.strip('"')
+    if depth > 8:
+        raise ValueError("macro %s is nested too deeply" % name)
+
+    value = INT_SUFFIX_RE.sub(r"\1", value)
+    value = NAME_RE.sub(lambda match: str(define_value(defines, match.group(0), depth + 1))
+                        if match.group(0) in defines else match.group(0), value)
+    if not ARITHMETIC_RE.match(value):
+        raise ValueError("macro %s is not an integer expression: %s" % (name, value))
+    return int(eval(value, {"__builtins__": {}}))
+
+
+def c_div(numerator, denominator):
+    """Integer division truncating towards zero like C."""
+    quotient = abs(numerator) // abs(denominator)
+    return quotient if (numerator >= 0) == (denominator >= 0) else -quotient
+
+
+def percentile(values, fraction):
+    """Returns the percentile of sorted values, or 0 without values."""
+    if not values:
+        return 0.0
+    return values[min(len(values) - 1, int(fraction * len(values)))]
+
+
+class Prng:
+    """xorshift32 generator of source/prng.c."""
+
+    def __init__(self, seed):
+        self.state = (seed & PRNG_MASK) or PRNG_DEFAULT_SEED
+
+    def next(self):
+        x = self.state
+        x ^= (x << 13) & PRNG_MASK
+        x ^= x >> 17
+        x ^= (x << 5) & PRNG_MASK
+        self.state = x
+        return x
+
+    def range(self, low, high):
+        span = high - low
+        if span == PRNG_MASK:
+            return self.next()
+        return low + self.next() % (span + 1)
+
+
+class Co2Synthetic:
+    """Room model of source/co2_synthetic.c."""
+
+    def __init__(self, config, seed):
+        self.config = config
+        self.prng = Prng(seed)
+        self.level_x16 = config["CO2_SYNTHETIC_OUTDOOR_PPM"] << LEVEL_SCALE_SHIFT
+        self.occupants = 0
+        self.phase_remaining_s = 0
+
+    def next(self, elapsed_s):
+        config = self.config
+        if self.phase_remaining_s <= elapsed_s:
+            # Start a new phase, half of the phases leave the room empty
+            if self.prng.next() & 1:
+                self.occupants = self.prng.range(1, config["CO2_SYNTHETIC_MAX_OCCUPANTS"])
+            else:
+                self.occupants = 0
+            self.phase_remaining_s = self.prng.range(config["CO2_SYNTHETIC_PHASE_MIN_S"],
+                                                     config["CO2_SYNTHETIC_PHASE_MAX_S"])
+        else:
+            self.phase_remaining_s -= elapsed_s
+
+        rise_x16 = ((self.occupants * config["CO2_SYNTHETIC_PPM_PER_OCCUPANT_MIN"] * elapsed_s)
+                    << LEVEL_SCALE_SHIFT) // 60
+        excess_x16 = self.level_x16 - (config["CO2_SYNTHETIC_OUTDOOR_PPM"] << LEVEL_SCALE_SHIFT)
+        decay_x16 = c_div(excess_x16 * elapsed_s, config["CO2_SYNTHETIC_VENTILATION_TAU_S"])
+        self.level_x16 += rise_x16 - decay_x16
+
+        noise = config["CO2_SYNTHETIC_NOISE_PPM"]
+        ppm = (self.level_x16 >> LEVEL_SCALE_SHIFT) + self.prng.range(0, 2 * noise) - noise
+        return max(0, min(CO2_SYNTHETIC_MAX_PPM, ppm))
+
+
+class Backoff:
+    """Decorrelated jitter backoff of source/backoff.c."""
+
+    def __init__(self, base_ms, cap_ms, seed):
+        self.prng = Prng(seed)
+        self.base_ms = base_ms
+        self.cap_ms = cap_ms
+        self.delay_ms = base_ms
+
+    def reset(self):
+        self.delay_ms = self.base_ms
+
+    def next_ms(self):
+        upper_ms = self.cap_ms
+        if self.delay_ms < self.cap_ms // BACKOFF_GROWTH_FACTOR:
+            upper_ms = self.delay_ms * BACKOFF_GROWTH_FACTOR
+        self.delay_ms = self.prng.range(self.base_ms, upper_ms)
+        return self.delay_ms
+
+
+class MqttError(Exception):
+    """Lost connection, protocol error, or refused connection."""
+
+
+def encode_length(length):
+    """Returns the MQTT remaining length field."""
+    encoded = bytearray()
+    while True:
+        byte = length % 128
+        length //= 128
+        encoded.append(byte | (0x80 if length else 0))
+        if not length:
+            return bytes(encoded)
+
+
+def encode_string(value):
+    """Returns a length prefixed UTF-8 string."""
+    data = value.encode("utf-8") if isinstance(value, str) else value
+    return struct.pack("!H", len(data)) + data
+
+
+def packet(packet_type, body):
+    """Returns a control packet with its fixed header."""
+    return bytes([packet_type]) + encode_length(len(body)) + body
+
+
+class MqttConnection:
+    """Minimal MQTT 3.1.1 client connection with QoS 0 and 1."""
+
+    def __init__(self, reader, writer, on_message):
+        self.reader = reader
+        self.writer = writer
+        self.on_message = on_message
+        self.next_packet_id = 0
+        self.pending = {}
+        self.closed = asyncio.Event()
+        self.reader_task = None
+
+    @classmethod
+    async def open(cls, args, client_id, on_message):
+        """Connects to the broker and waits for the CONNACK."""
+        tls = None
+        if args.tls:
+            tls = ssl.create_default_context(cafile=args.cafile)
+            if args.cert:
+                tls.load_cert_chain(args.cert, args.key)
+            if args.insecure:
+                tls.check_hostname = False
+                tls.verify_mode = ssl.CERT_NONE
+
+        timeout_s = args.timeout_ms / 1000.0
+        try:
+            reader, writer = await asyncio.wait_for(
+                asyncio.open_connection(args.broker, args.port, ssl=tls), timeout_s)
+        except (OSError, asyncio.TimeoutError) as error:
+            raise MqttError("connect: %s" % (error or "timeout"))
+        connection = cls(reader, writer, on_message)
+
+        flags = 0x02
+        payload = encode_string(client_id)
+        if args.username:
+            flags |= 0x80
+            payload += encode_string(args.username)
+            if args.password:
+                flags |= 0x40
+                payload += encode_string(args.password)
+        body = encode_string("MQTT") + bytes([4, flags]) + struct.pack("!H", args.keepalive) + payload
+
+        try:
+            writer.write(packet(MQTT_CONNECT, body))
+            packet_type, data = await asyncio.wait_for(connection.read_packet(), timeout_s)
+        except (OSError, asyncio.IncompleteReadError, asyncio.TimeoutError) as error:
+            writer.close()
+            raise MqttError("CONNACK: %s" % (error or "timeout"))
+        if (packet_type & 0xF0) != MQTT_CONNACK or len(data) != 2 or data[1] != 0:
+            writer.close()
+            raise MqttError("connection refused (%s)" % (data[1] if len(data) == 2 else "bad CONNACK"))
+
+        connection.reader_task = asyncio.ensure_future(connection.read_loop())
+        return connection
+
+    async def read_packet(self):
+        """Returns the type byte and the body of the next packet."""
+        header = await self.reader.readexactly(1)
+        length = 0
+        multiplier = 1
+        while True:
+            byte = (await self.reader.readexactly(1))[0]
+            length += (byte & 0x7F) * multiplier
+            multiplier *= 128
+            if not byte & 0x80:
+                break
+        data = await self.reader.readexactly(length) if length else b""
+        return header[0], data
+
+    async def read_loop(self):
+        """Dispatches the acknowledgments and the incoming messages."""
+        try:
+            while True:
+                packet_type, data = await self.read_packet()
+                kind = packet_type & 0xF0
+                if kind in (MQTT_PUBACK, MQTT_SUBACK & 0xF0):
+                    future = self.pending.pop(struct.unpack("!H", data[:2])[0], None)
+                    if future and not future.done():
+                        future.set_result(time.monotonic())
+                elif kind == MQTT_PINGRESP:
+                    future = self.pending.pop("ping", None)
+                    if future and not future.done():
+                        future.set_result(time.monotonic())
+                elif kind == MQTT_PUBLISH:
+                    qos = (packet_type >> 1) & 0x03
+                    topic_len = struct.unpack("!H", data[:2])[0]
+                    topic = data[2:2 + topic_len].decode("utf-8", "replace")
+                    offset = 2 + topic_len
+                    if qos:
+                        self.writer.write(packet(MQTT_PUBACK, data[offset:offset + 2]))
+                        offset += 2
+                    self.on_message(topic, data[offset:])
+        except (OSError, asyncio.IncompleteReadError, struct.error):
+            pass
+        finally:
+            self.abort()
+
+    def abort(self):
+        """Drops the connection without a DISCONNECT, like a lost link."""
+        if self.closed.is_set():
+            return
+        self.closed.set()
+        for future in self.pending.values():
+            if not future.done():
+                future.set_exception(MqttError("connection lost"))
+        self.pending.clear()
+        transport = self.writer.transport
+        if transport is not None:
+            transport.abort()
+
+    async def close(self):
+        """Sends a DISCONNECT and closes the connection."""
+        if not self.closed.is_set():
+            try:
+                self.writer.write(packet(MQTT_DISCONNECT, b""))
+                await self.writer.drain()
+            except OSError:
+                pass
+        self.abort()
+
+    def packet_id(self):
+        self.next_packet_id = self.next_packet_id % 0xFFFF + 1
+        return self.next_packet_id
+
+    async def request(self, key, data, timeout_s):
+        """Sends a packet and waits for its acknowledgment. Returns the
+        round trip time in seconds."""
+        if self.closed.is_set():
+            raise MqttError("connection lost")
+        future = asyncio.get_running_loop().create_future()
+        self.pending[key] = future
+        start = time.monotonic()
+        try:
+            self.writer.write(data)
+            await self.writer.drain()
+            return await asyncio.wait_for(future, timeout_s) - start
+        except asyncio.TimeoutError:
+            self.pending.pop(key, None)
+            raise
+        except OSError as error:
+            self.abort()
+            raise MqttError(str(error))
+
+    async def publish(self, topic, payload, qos, timeout_s, dup=False):
+        """Publishes a message. Returns the PUBACK latency in seconds, or 0
+        for QoS 0."""
+        body = encode_string(topic)
+        if qos == 0:
+            if self.closed.is_set():
+                raise MqttError("connection lost")
+            self.writer.write(packet(MQTT_PUBLISH, body + payload))
+            try:
+                await self.writer.drain()
+            except OSError as error:
+                self.abort()
+                raise MqttError(str(error))
+            return 0.0
+        packet_id = self.packet_id()
+        header = MQTT_PUBLISH | (qos << 1) | (0x08 if dup else 0)
+        return await self.request(packet_id, packet(header, body + struct.pack("!H", packet_id) + payload),
+                                  timeout_s)
+
+    async def subscribe(self, topic, qos, timeout_s):
+        packet_id = self.packet_id()
+        body = struct.pack("!H", packet_id) + encode_string(topic) + bytes([qos])
+        await self.request(packet_id, packet(MQTT_SUBSCRIBE, body), timeout_s)
+
+    async def ping(self, timeout_s):
+        await self.request("ping", packet(MQTT_PINGREQ, b""), timeout_s)
+
+
+class Metrics:
+    """Counters of the fleet, per report interval and for the whole run."""
+
+    def __init__(self, devices):
+        self.devices = devices
+        self.connected = 0
+        self.totals = collections.Counter()
+        self.interval = collections.Counter()
+        self.latencies_ms = []
+        self.interval_latencies_ms = []
+        self.connect_ms = []
+        self.reconnects_per_s = collections.Counter()
+        self.storms = []
+
+    def count(self, name, amount=1):
+        self.totals[name] += amount
+        self.interval[name] += amount
+
+    def puback(self, latency_s):
+        latency_ms = latency_s * 1000.0
+        self.latencies_ms.append(latency_ms)
+        self.interval_latencies_ms.append(latency_ms)
+
+    def reconnect(self, elapsed_s):
+        self.count("reconnects")
+        self.reconnects_per_s[int(elapsed_s)] += 1
+
+
+class Device:
+    """One virtual device: sensor, publisher, subscriber and connection."""
+
+    def __init__(self, sim, index):
+        self.sim = sim
+        self.args = sim.args
+        self.config = sim.config
+        seed = ((sim.args.seed ^ index) * 2654435761) & PRNG_MASK
+        self.client_id = "%s-%05d" % (sim.args.client_prefix, index)
+        self.device_id = "%08x%08x" % (sim.args.seed & PRNG_MASK, index)
+        self.synthetic = Co2Synthetic(sim.config, seed)
+        self.jitter_prng = Prng(seed ^ 0x5A5A5A5A)
+        self.backoff = Backoff(self.config["MQTT_CONN_RETRY_INTERVAL_MS"],
+                               self.config["MQTT_CONN_RETRY_MAX_INTERVAL_MS"], seed ^ 0xA5A5A5A5)
+        self.period_s = sim.args.period
+        self.seq = 0
+        self.outbox = collections.deque()
+        self.outbox_event = asyncio.Event()
+        self.connection = None
+        self.connected_once = False
+        self.pub_topic = self.topic(self.config["MQTT_PUB_TOPIC"])
+        self.sub_topic = self.topic(self.config["MQTT_SUB_TOPIC"])
+        self.ack_topic = self.topic(self.config["MQTT_CONFIG_ACK_TOPIC"])
+
+    def topic(self, template):
+        """Expands a topic template like source/mqtt_topic.c."""
+        return template.replace("{client_id}", self.client_id).replace("{device_id}", self.device_id)
+
+    def queue(self, topic, payload, qos, telemetry):
+        """Queues a message. Telemetry beyond the redelivery ring and the
+        publisher queue is dropped oldest first, other messages are dropped
+        while disconnected, like the firmware publisher."""
+        if not telemetry and self.connection is None:
+            self.sim.metrics.count("dropped")
+            return
+        if len(self.outbox) >= self.sim.outbox_limit:
+            self.outbox.popleft()
+            self.sim.metrics.count("lost")
+        self.outbox.append((topic, payload, qos, telemetry))
+        self.outbox_event.set()
+
+    async def sample_loop(self):
+        """Generates a sample every period plus a random jitter."""
+        last = time.monotonic()
+        while True:
+            jitter_ms = self.jitter_prng.range(0, self.args.jitter_ms) if self.args.jitter_ms else 0
+            await asyncio.sleep(self.period_s + jitter_ms / 1000.0)
+            now = time.monotonic()
+            elapsed_s = max(1, int(round(now - last)))
+            last = now
+
+            ppm = self.synthetic.next(elapsed_s)
+            self.seq += 1
+            payload = '{"CO2 PPM Level": "%d", "ts": %d, "seq": %d}' % (ppm, int(time.time() * 1000), self.seq)
+            self.sim.metrics.count("samples")
+            self.queue(self.pub_topic, payload.encode("ascii"), self.config["MQTT_TELEMETRY_QOS"], True)
+
+    def on_message(self, topic, payload):
+        """Applies a configuration message and queues the acknowledgment."""
+        self.sim.metrics.count("config_rx")
+        try:
+            config = json.loads(payload.decode("utf-8"))
+            period = int(config["pasco2_measurement_period"])
+        except (ValueError, KeyError, TypeError):
+            return
+        if MEAS_RATE_MIN_S <= period <= MEAS_RATE_MAX_S:
+            self.period_s = period
+            ack = "Config => pasco2_measurement_period: %d" % period
+            self.queue(self.ack_topic, ack.encode("ascii"), self.config["MQTT_CONFIG_ACK_QOS"], False)
+
+    async def publish_loop(self, connection, flush):
+        """Publishes the queued messages one at a time. Messages held during
+        a disconnection are flushed at the limited rate of the firmware."""
+        timeout_s = self.args.timeout_ms / 1000.0
+        flush_s = self.config["MQTT_PUB_FLUSH_INTERVAL_MS"] / 1000.0
+        dup = False
+        while not connection.closed.is_set():
+            if not self.outbox:
+                self.outbox_event.clear()
+                await self.outbox_event.wait()
+                continue
+            if flush > 0:
+                flush -= 1
+                await asyncio.sleep(flush_s)
+
+            topic, payload, qos, _ = self.outbox[0]
+            try:
+                latency_s = await connection.publish(topic, payload, qos, timeout_s, dup)
+            except asyncio.TimeoutError:
+                # Kept and published again, like the redelivery ring
+                self.sim.metrics.count("timeouts")
+                dup = True
+                continue
+            except MqttError:
+                return
+            dup = False
+            if self.outbox and self.outbox[0][1] is payload:
+                self.outbox.popleft()
+            self.sim.metrics.count("published")
+            if qos:
+                self.sim.metrics.puback(latency_s)
+
+    async def ping_loop(self, connection):
+        """Sends a PINGREQ every keep alive interval."""
+        timeout_s = self.args.timeout_ms / 1000.0
+        while not connection.closed.is_set():
+            await asyncio.sleep(self.args.keepalive)
+            try:
+                await connection.ping(timeout_s)
+            except (MqttError, asyncio.TimeoutError):
+                connection.abort()
+                return
+
+    async def run(self, start_delay_s):
+        """Connects, serves the connection until it is lost, and reconnects
+        with backoff."""
+        await asyncio.sleep(start_delay_s)
+        sampler = asyncio.ensure_future(self.sample_loop())
+        metrics = self.sim.metrics
+        try:
+            while True:
+                if self.connected_once:
+                    metrics.reconnect(time.monotonic() - self.sim.start)
+                metrics.count("connect_attempts")
+                start = time.monotonic()
+                try:
+                    connection = await MqttConnection.open(self.args, self.client_id, self.on_message)
+                except MqttError:
+                    metrics.count("connect_failures")
+                    await asyncio.sleep(self.backoff.next_ms() / 1000.0)
+                    continue
+                metrics.connect_ms.append((time.monotonic() - start) * 1000.0)
+                self.backoff.reset()
+
+                self.connection = connection
+                self.connected_once = True
+                metrics.connected += 1
+                tasks = []
+                try:
+                    await connection.subscribe(self.sub_topic, 1, self.args.timeout_ms / 1000.0)
+                    self.sim.sessions.add(connection)
+                    tasks = [asyncio.ensure_future(self.publish_loop(connection, len(self.outbox))),
+                             asyncio.ensure_future(self.ping_loop(connection))]
+                    await connection.closed.wait()
+                except (MqttError, asyncio.TimeoutError):
+                    connection.abort()
+                finally:
+                    for task in tasks:
+                        task.cancel()
+                    self.sim.sessions.discard(connection)
+                    self.connection = None
+                    metrics.connected -= 1
+                if not self.sim.stopping:
+                    metrics.count("disconnects")
+        finally:
+            sampler.cancel()
+
+
+class FleetSim:
+    """Runs the devices and prints the reports."""
+
+    def __init__(self, args, config):
+        self.args = args
+        self.config = config
+        self.metrics = Metrics(args.devices)
+        self.sessions = set()
+        self.stopping = False
+        self.start = 0.0
+        self.outbox_limit = config["PUBLISH_RETRY_RING_LENGTH"] + args.queue_length
+
+    def report(self, elapsed_s, interval_s):
+        """Prints and resets the counters of one report interval."""
+        metrics = self.metrics
+        interval = metrics.interval
+        latencies = sorted(metrics.interval_latencies_ms)
+        print("t=%5ds conn %5d/%d  pub %8.1f/s  puback ms p50 %6.1f p90 %6.1f p99 %6.1f max %7.1f  "
+              "timeout %d  lost %d  reconn %d" % (
+                  elapsed_s, metrics.connected, self.args.devices, interval["published"] / interval_s,
+                  percentile(latencies, 0.50), percentile(latencies, 0.90), percentile(latencies, 0.99),
+                  latencies[-1] if latencies else 0.0, interval["timeouts"], interval["lost"],
+                  interval["reconnects"]))
+
+        if interval["reconnects"] >= max(1, self.args.storm_fraction * self.args.devices):
+            first = int(elapsed_s - interval_s)
+            peak = max(metrics.reconnects_per_s.get(second, 0) for second in range(first, int(elapsed_s) + 1))
+            metrics.storms.append({"t_s": int(elapsed_s), "reconnects": interval["reconnects"],
+                                   "peak_per_s": peak})
+            print("RECONNECT STORM: %d attempts in %d s (%.0f%% of the fleet), peak %d/s" % (
+                interval["reconnects"], interval_s, 100.0 * interval["reconnects"] / self.args.devices, peak))
+
+        metrics.interval = collections.Counter()
+        metrics.interval_latencies_ms = []
+
+    async def drop_connections(self):
+        """Drops a part of the connections at once, e.g. to replay a broker
+        failover and the reconnect storm that follows it."""
+        await asyncio.sleep(self.args.drop_at)
+        sessions = list(self.sessions)
+        count = int(len(sessions) * self.args.drop_fraction)
+        print("Dropping %d of %d connections" % (count, len(sessions)))
+        for connection in random.Random(self.args.seed).sample(sessions, count):
+            connection.abort()
+
+    async def run(self):
+        self.start = time.monotonic()
+        ramp_s = self.args.ramp / max(1, self.args.devices)
+        devices = [asyncio.ensure_future(Device(self, index).run(index * ramp_s))
+                   for index in range(self.args.devices)]
+        dropper = asyncio.ensure_future(self.drop_connections()) if self.args.drop_fraction > 0 else None
+
+        elapsed_s = 0
+        while (self.args.duration == 0) or (elapsed_s < self.args.duration):
+            interval_s = self.args.report_interval
+            if self.args.duration:
+                interval_s = min(interval_s, self.args.duration - elapsed_s)
+            await asyncio.sleep(interval_s)
+            elapsed_s += interval_s
+            self.report(elapsed_s, interval_s)
+
+        self.stopping = True
+        for task in devices + ([dropper] if dropper else []):
+            task.cancel()
+        for connection in list(self.sessions):
+            await connection.close()
+        await asyncio.gather(*devices, return_exceptions=True)
+        return self.summary(elapsed_s)
+
+    def summary(self, elapsed_s):
+        """Prints the summary of the run and returns it as a dictionary."""
+        metrics = self.metrics
+        totals = metrics.totals
+        latencies = sorted(metrics.latencies_ms)
+        connect_ms = sorted(metrics.connect_ms)
+        histogram = collections.OrderedDict()
+        lower = 0
+        for upper in LATENCY_BUCKETS_MS:
+            histogram["<%d" % upper] = sum(1 for value in latencies if lower <= value < upper)
+            lower = upper
+        histogram[">=%d" % lower] = sum(1 for value in latencies if value >= lower)
+
+        summary = {
+            "devices": self.args.devices,
+            "duration_s": elapsed_s,
+            "samples": totals["samples"],
+            "published": totals["published"],
+            "publish_per_s": totals["published"] / max(1, elapsed_s),
+            "timeouts": totals["timeouts"],
+            "lost": totals["lost"],
+            "dropped": totals["dropped"],
+            "config_rx": totals["config_rx"],
+            "puback_ms": {
+                "n": len(latencies),
+                "p50": percentile(latencies, 0.50),
+                "p90": percentile(latencies, 0.90),
+                "p99": percentile(latencies, 0.99),
+                "p999": percentile(latencies, 0.999),
+                "max": latencies[-1] if latencies else 0.0,
+                "histogram": histogram,
+            },
+            "connect_ms": {
+                "n": len(connect_ms),
+                "p50": percentile(connect_ms, 0.50),
+                "p99": percentile(connect_ms, 0.99),
+                "max": connect_ms[-1] if connect_ms else 0.0,
+            },
+            "connect_attempts": totals["connect_attempts"],
+            "connect_failures": totals["connect_failures"],
+            "disconnects": totals["disconnects"],
+            "reconnects": totals["reconnects"],
+            "reconnect_peak_per_s": max(metrics.reconnects_per_s.values()) if metrics.reconnects_per_s else 0,
+            "storms": metrics.storms,
+        }
+
+        print("\nFleet of %d devices for %d s:" % (self.args.devices, elapsed_s))
+        print("  samples %d, published %d (%.1f/s), timeouts %d, lost %d, dropped %d, config messages %d" % (
+            summary["samples"], summary["published"], summary["publish_per_s"], summary["timeouts"],
+            summary["lost"], summary["dropped"], summary["config_rx"]))
+        print("  PUBACK latency ms: n %d, p50 %.1f, p90 %.1f, p99 %.1f, p99.9 %.1f, max %.1f" % (
+            len(latencies), summary["puback_ms"]["p50"], summary["puback_ms"]["p90"],
+            summary["puback_ms"]["p99"], summary["puback_ms"]["p999"], summary["puback_ms"]["max"]))
+        print("  PUBACK histogram ms: " + ", ".join("%s: %d" % item for item in histogram.items()))
+        print("  connect ms (TCP, TLS, CONNACK): p50 %.1f, p99 %.1f, max %.1f" % (
+            summary["connect_ms"]["p50"], summary["connect_ms"]["p99"], summary["connect_ms"]["max"]))
+        print("  connect attempts %d, failed %d, disconnects %d, reconnects %d, peak %d/s, storms %d" % (
+            summary["connect_attempts"], summary["connect_failures"], summary["disconnects"],
+            summary["reconnects"], summary["reconnect_peak_per_s"], len(metrics.storms)))
+        return summary
+
+
+def parse_args(config):
+    parser = argparse.ArgumentParser(description="Runs a fleet of virtual PAS CO2 devices against an MQTT broker.")
+    parser.add_argument("--broker", default="localhost", help="broker hostname (default: %(default)s)")
+    parser.add_argument("--port", type=int, default=1883, help="broker port (default: %(default)s)")
+    parser.add_argument("--tls", action="store_true", help="connect with TLS")
+    parser.add_argument("--cafile", help="root CA certificate of the broker")
+    parser.add_argument("--cert", help="client certificate")
+    parser.add_argument("--key", help="private key of the client certificate")
+    parser.add_argument("--insecure", action="store_true", help="do not verify the broker certificate")
+    parser.add_argument("--username", default="", help="MQTT user name")
+    parser.add_argument("--password", default="", help="MQTT password")
+    parser.add_argument("--devices", type=int, default=100, help="number of devices (default: %(default)s)")
+    parser.add_argument("--client-prefix", default="pasco2-sim", help="client identifier prefix (default: %(default)s)")
+    parser.add_argument("--period", type=float, default=10.0,
+                        help="measurement period in seconds (default: %(default)s)")
+    parser.add_argument("--jitter-ms", type=int, default=config["PASCO2_PUBLISH_JITTER_MS"],
+                        help="maximum random delay added to each period (default: %(default)s)")
+    parser.add_argument("--ramp", type=float, default=0.0,
+                        help="seconds over which the devices are started (default: all at once)")
+    parser.add_argument("--duration", type=int, default=60, help="run time in seconds, 0 runs until stopped "
+                        "(default: %(default)s)")
+    parser.add_argument("--report-interval", type=int, default=5, help="seconds between reports (default: %(default)s)")
+    parser.add_argument("--keepalive", type=int, default=config["MQTT_KEEP_ALIVE_SECONDS"],
+                        help="MQTT keep alive in seconds (default: %(default)s)")
+    parser.add_argument("--timeout-ms", type=int, default=config["MQTT_TIMEOUT_MS"],
+                        help="timeout of the connection and the acknowledgments (default: %(default)s)")
+    parser.add_argument("--queue-length", type=int, default=config["PUBLISHER_TASK_QUEUE_LENGTH"],
+                        help="publisher queue length added to the redelivery ring (default: %(default)s)")
+    parser.add_argument("--storm-fraction", type=float, default=0.1,
+                        help="part of the fleet reconnecting in one report interval that is reported as "
+                             "a reconnect storm (default: %(default)s)")
+    parser.add_argument("--drop-at", type=float, default=10.0,
+                        help="second at which connections are dropped (default: %(default)s)")
+    parser.add_argument("--drop-fraction", type=float, default=0.0,
+                        help="part of the connections dropped at --drop-at (default: none)")
+    parser.add_argument("--seed", type=lambda value: int(value, 0), default=1,
+                        help="seed of the synthetic sources of the fleet (default: %(default)s)")
+    parser.add_argument("--json", help="write the summary to this file")
+    return parser.parse_args()
+
+
+def main():
+    defines = read_defines(APP_ROOT)
+    names = ("CO2_SYNTHETIC_OUTDOOR_PPM", "CO2_SYNTHETIC_PPM_PER_OCCUPANT_MIN", "CO2_SYNTHETIC_MAX_OCCUPANTS",
+             "CO2_SYNTHETIC_VENTILATION_TAU_S", "CO2_SYNTHETIC_PHASE_MIN_S", "CO2_SYNTHETIC_PHASE_MAX_S",
+             "CO2_SYNTHETIC_NOISE_PPM", "PASCO2_PUBLISH_JITTER_MS", "PUBLISH_RETRY_RING_LENGTH",
+             "PUBLISHER_TASK_QUEUE_LENGTH", "MQTT_PUB_TOPIC", "MQTT_SUB_TOPIC", "MQTT_CONFIG_ACK_TOPIC",
+             "MQTT_CONFIG_ACK_QOS", "MQTT_TELEMETRY_QOS", "MQTT_PUB_FLUSH_INTERVAL_MS", "MQTT_KEEP_ALIVE_SECONDS",
+             "MQTT_TIMEOUT_MS", "MQTT_CONN_RETRY_INTERVAL_MS", "MQTT_CONN_RETRY_MAX_INTERVAL_MS")
+    config = {name: define_value(defines, name) for name in names}
+
+    args = parse_args(config)
+    if args.devices < 1:
+        print("fleet_sim.py: --devices must be at least 1")
+        return 1
+
+    print("Fleet of %d devices on %s:%d, period %.1f s, jitter %d ms, QoS %d to '%s'" % (
+        args.devices, args.broker, args.port, args.period, args.jitter_ms, config["MQTT_TELEMETRY_QOS"],
+        config["MQTT_PUB_TOPIC"]))
+
+    sim = FleetSim(args, config)
+    try:
+        summary = asyncio.run(sim.run())
+    except KeyboardInterrupt:
+        return 1
+
+    if args.json:
+        with open(args.json, "w") as json_file:
+            json.dump(summary, json_file, indent=2)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
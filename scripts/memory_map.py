@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+"""
+File Name:   memory_map.py
+
+Description: Post-build step that reads the GNU linker map file of the
+             application and reports the flash and RAM used by each source
+             file of the application and by each library. The report is
+             printed and written next to the map file with the extension
+             '.memory.txt'. With the map file of an earlier build, the
+             change of the flash and RAM use of each subsystem is printed as
+             well, e.g. to measure the saving of a build option.
+
+             Usage: memory_map.py <application>.map [<baseline>.map]
+
+Related Document: See README.md
+
+===========================================================================
+Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+===========================================================================
+
+===========================================================================
+Infineon Technologies AG (INFINEON) is supplying this file for use
+exclusively with Infineon's sensor products. This file can be freely
+distributed within development tools and software supporting such
+products.
+
+THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+WHATSOEVER.
+===========================================================================
+"""
+
+import os
+import re
+import sys
+
+# Input section in one line, or its address, size and object file on the
+# line after a long section name.
+SECTION_RE = re.compile(r"^ (\.\S+|COMMON)(?:\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*))?$")
+CONTINUATION_RE = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+
+# Output sections that hold the heap and the main stack
+HEAP_SECTION_RE = re.compile(r"^\.heap\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)")
+STACK_SECTION_RE = re.compile(r"^\.stack_dummy\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)")
+
+# Library folders of the ModusToolbox shared and local library directories
+LIBRARY_RE = re.compile(r"(?:^|/)(?:mtb_shared|libs)/([^/]+)/")
+ARCHIVE_RE = re.compile(r"([^/]+)\.a\((.+)\)$")
+
+CATEGORIES = ("text", "rodata", "data", "bss")
+
+
+def section_category(name):
+    """Returns the category of an input section, or None if not counted."""
+    if name.startswith((".text", ".ARM.exidx", ".ARM.extab", ".init", ".fini", ".cy_ramfunc")):
+        return "text"
+    if name.startswith(".rodata"):
+        return "rodata"
+    if name.startswith(".data"):
+        return "data"
+    if name.startswith((".bss", ".noinit", ".cy_sharedmem")) or name == "COMMON":
+        return "bss"
+    return None
+
+
+def subsystem(path):
+    """Returns the subsystem an object file belongs to."""
+    path = path.strip().replace("\\", "/")
+
+    library = LIBRARY_RE.search(path)
+    if library:
+        return library.group(1)
+
+    archive = ARCHIVE_RE.search(path)
+    if archive:
+        return "toolchain (" + archive.group(1) + ")"
+
+    if "/source/" in path or path.startswith("source/"):
+        return "app: " + os.path.splitext(os.path.basename(path))[0]
+
+    return "other"
+
+
+def parse(map_path):
+    """Returns the sizes per subsystem and category, the heap and the stack."""
+    usage = {}
+    heap = 0
+    stack = 0
+    in_map = False
+    pending = None
+
+    with open(map_path, "r", errors="replace") as map_file:
+        for line in map_file:
+            line = line.rstrip("\n")
+            if not in_map:
+                in_map = line.startswith("Linker script and memory map")
+                continue
+
+            match = HEAP_SECTION_RE.match(line)
+            if match:
+                heap = int(match.group(2), 16)
+                continue
+            match = STACK_SECTION_RE.match(line)
+            if match:
+                stack = int(match.group(2), 16)
+                continue
+
+            if pending is not None:
+                match = CONTINUATION_RE.match(line)
+                name = pending
+                pending = None
+                if not match:
+                    continue
+                address, size, path = match.groups()
+            else:
+                match = SECTION_RE.match(line)
+                if not match:
+                    continue
+                name, address, size, path = match.groups()
+                if address is None:
+                    pending = name
+                    continue
+
+            category = section_category(name)
+            size = int(size, 16)
+            if category is None or size == 0 or int(address, 16) == 0:
+                continue
+
+            sizes = usage.setdefault(subsystem(path), dict.fromkeys(CATEGORIES, 0))
+            sizes[category] += size
+
+    return usage, heap, stack
+
+
+def report(usage, heap, stack):
+    """Returns the report as a list of lines."""
+    lines = []
+    header = "%-40s %8s %8s %8s %8s %8s %8s" % (
+        "Subsystem", "text", "rodata", "data", "bss", "Flash", "RAM")
+    lines.append(header)
+    lines.append("-" * len(header))
+
+    totals = dict.fromkeys(CATEGORIES, 0)
+    rows = []
+    for name, sizes in usage.items():
+        flash = sizes["text"] + sizes["rodata"] + sizes["data"]
+        ram = sizes["data"] + sizes["bss"]
+        rows.append((ram, flash, name, sizes))
+        for category in CATEGORIES:
+            totals[category] += sizes[category]
+
+    # Largest RAM users first
+    for ram, flash, name, sizes in sorted(rows, key=lambda row: (-row[0], -row[1], row[2])):
+        lines.append("%-40s %8d %8d %8d %8d %8d %8d" % (
+            name, sizes["text"], sizes["rodata"], sizes["data"], sizes["bss"], flash, ram))
+
+    lines.append("-" * len(header))
+    lines.append("%-40s %8d %8d %8d %8d %8d %8d" % (
+        "Total", totals["text"], totals["rodata"], totals["data"], totals["bss"],
+        totals["text"] + totals["rodata"] + totals["data"], totals["data"] + totals["bss"]))
+    lines.append("")
+    lines.append("Heap reserved by the linker: %d bytes" % heap)
+    lines.append("Main stack: %d bytes" % stack)
+    return lines
+
+
+def flash_ram(sizes):
+    """Returns the flash and RAM use of one subsystem."""
+    return (sizes["text"] + sizes["rodata"] + sizes["data"], sizes["data"] + sizes["bss"])
+
+
+def compare(usage, baseline):
+    """Returns the change from the baseline as a list of lines."""
+    lines = []
+    header = "%-40s %8s %8s" % ("Subsystem", "Flash", "RAM")
+    lines.append(header)
+    lines.append("-" * len(header))
+
+    empty = dict.fromkeys(CATEGORIES, 0)
+    total_flash = 0
+    total_ram = 0
+    for name in sorted(set(usage) | set(baseline)):
+        flash, ram = flash_ram(usage.get(name, empty))
+        base_flash, base_ram = flash_ram(baseline.get(name, empty))
+        if (flash, ram) == (base_flash, base_ram):
+            continue
+        lines.append("%-40s %+8d %+8d" % (name, flash - base_flash, ram - base_ram))
+        total_flash += flash - base_flash
+        total_ram += ram - base_ram
+
+    lines.append("-" * len(header))
+    lines.append("%-40s %+8d %+8d" % ("Total", total_flash, total_ram))
+    return lines
+
+
+def main():
+    if len(sys.argv) not in (2, 3):
+        print("Usage: memory_map.py <application>.map [<baseline>.map]")
+        return 1
+
+    map_path = sys.argv[1]
+    if not os.path.isfile(map_path):
+        print("memory_map.py: map file '%s' not found, no memory report" % map_path)
+        return 0
+
+    usage, heap, stack = parse(map_path)
+    lines = report(usage, heap, stack)
+
+    with open(os.path.splitext(map_path)[0] + ".memory.txt", "w") as report_file:
+        report_file.write("\n".join(lines) + "\n")
+
+    print("\nMemory use per subsystem (bytes):")
+    print("\n".join(lines))
+
+    if len(sys.argv) == 3:
+        baseline_path = sys.argv[2]
+        if not os.path.isfile(baseline_path):
+            print("memory_map.py: baseline map file '%s' not found, no comparison" % baseline_path)
+            return 0
+        baseline, _, _ = parse(baseline_path)
+        print("\nChange from '%s' (bytes):" % baseline_path)
+        print("\n".join(compare(usage, baseline)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
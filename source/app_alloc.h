@@ -0,0 +1,156 @@
+/******************************************************************************
+ * File Name:   app_alloc.h
+ *
+ * Description: This file contains the macros that create the tasks, queues
+ *              and mutexes of the application either from the FreeRTOS heap
+ *              or from statically allocated memory.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+#include "FreeRTOS.h"
+#include "event_groups.h"
+#include "queue.h"
+#include "semphr.h"
+#include "task.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Set to 1 (or build with STATIC_ALLOC=1) to place the stacks, control blocks
+ * and queue storage of the application in statically allocated memory. Their
+ * size is then reported by the linker and the memory map instead of being
+ * taken from the FreeRTOS heap at run time. The allocations inside the MQTT,
+ * Wi-Fi and network libraries still use the heap.
+ */
+#ifndef APP_STATIC_ALLOCATION
+#define APP_STATIC_ALLOCATION           (0)
+#endif
+
+/* Each object is declared with the *_MEMORY macro at file scope and created
+ * with the matching *_CREATE macro. The first argument names the memory, so
+ * an object can be created only once in the static build.
+ */
+#if (APP_STATIC_ALLOCATION != 0)
+
+#define APP_TASK_MEMORY(task, stack_size) \
+    static StackType_t task##_stack[(stack_size)]; \
+    static StaticTask_t task##_tcb
+
+#define APP_TASK_CREATE(task, name, stack_size, param, priority, handle) \
+    app_task_created(xTaskCreateStatic((task), (name), (stack_size), (param), \
+                                       (priority), task##_stack, &task##_tcb), \
+                     (handle))
+
+#define APP_QUEUE_MEMORY(queue, length, item_size) \
+    static uint8_t queue##_storage[(length) * (item_size)]; \
+    static StaticQueue_t queue##_control
+
+#define APP_QUEUE_CREATE(queue, length, item_size) \
+    xQueueCreateStatic((length), (item_size), queue##_storage, &queue##_control)
+
+#define APP_MUTEX_MEMORY(mutex) \
+    static StaticSemaphore_t mutex##_control
+
+#define APP_MUTEX_CREATE(mutex) \
+    xSemaphoreCreateMutexStatic(&mutex##_control)
+
+#define APP_BINARY_MEMORY(semaphore) \
+    static StaticSemaphore_t semaphore##_control
+
+#define APP_BINARY_CREATE(semaphore) \
+    xSemaphoreCreateBinaryStatic(&semaphore##_control)
+
+#define APP_EVENT_GROUP_MEMORY(group) \
+    static StaticEventGroup_t group##_control
+
+#define APP_EVENT_GROUP_CREATE(group) \
+    xEventGroupCreateStatic(&group##_control)
+
+#else
+
+/* The declarations are never defined nor used, they only keep the *_MEMORY
+ * macros valid at file scope.
+ */
+#define APP_TASK_MEMORY(task, stack_size) \
+    extern StaticTask_t task##_tcb
+
+#define APP_TASK_CREATE(task, name, stack_size, param, priority, handle) \
+    xTaskCreate((task), (name), (stack_size), (param), (priority), (handle))
+
+#define APP_QUEUE_MEMORY(queue, length, item_size) \
+    extern StaticQueue_t queue##_control
+
+#define APP_QUEUE_CREATE(queue, length, item_size) \
+    xQueueCreate((length), (item_size))
+
+#define APP_MUTEX_MEMORY(mutex) \
+    extern StaticSemaphore_t mutex##_control
+
+#define APP_MUTEX_CREATE(mutex) \
+    xSemaphoreCreateMutex()
+
+#define APP_BINARY_MEMORY(semaphore) \
+    extern StaticSemaphore_t semaphore##_control
+
+#define APP_BINARY_CREATE(semaphore) \
+    xSemaphoreCreateBinary()
+
+#define APP_EVENT_GROUP_MEMORY(group) \
+    extern StaticEventGroup_t group##_control
+
+#define APP_EVENT_GROUP_CREATE(group) \
+    xEventGroupCreate()
+
+#endif /* APP_STATIC_ALLOCATION */
+
+/*******************************************************************************
+ * Functions
+ *******************************************************************************/
+#if (APP_STATIC_ALLOCATION != 0)
+/*******************************************************************************
+ * Function Name: app_task_created
+ *******************************************************************************
+ * Summary:
+ *   Stores the handle of a statically created task and converts it to the
+ *   return value of xTaskCreate().
+ *
+ * Parameters:
+ *   created: Handle returned by xTaskCreateStatic()
+ *   handle: Location to store the handle, can be NULL
+ *
+ * Return:
+ *   BaseType_t: pdPASS if the task was created, pdFAIL otherwise
+ ******************************************************************************/
+static inline BaseType_t app_task_created(TaskHandle_t created, TaskHandle_t *handle)
+{
+    if (handle != NULL)
+    {
+        *handle = created;
+    }
+
+    return (created != NULL) ? pdPASS : pdFAIL;
+}
+#endif
+
+/* [] END OF FILE */
@@ -0,0 +1,131 @@
+/******************************************************************************
+ * File Name:   app_event_loop.c
+ *
+ * Description: This file contains the event loop task of the APP_EVENT_LOOP_ENABLED
+ *              build. The task waits on a queue set of the publisher, subscriber
+ *              and pasco2 configuration queues and runs their handlers, replacing
+ *              the three tasks that each blocked on one of these queues.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#include <stdio.h>
+
+/* FreeRTOS header files */
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "task.h"
+
+/* Task header files */
+#include "app_event_loop.h"
+#include "pasco2_config_task.h"
+#include "publisher_task.h"
+#include "subscriber_task.h"
+
+#if (APP_EVENT_LOOP_ENABLED != 0)
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* A queue set holds one event per item of each of its queues */
+#define APP_EVENT_LOOP_SET_LENGTH   (PUBLISHER_TASK_QUEUE_LENGTH + MQTT_SUB_QUEUE_LENGTH + \
+                                     PASCO2_CONFIG_QUEUE_LENGTH)
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+TaskHandle_t app_event_loop_task_handle = NULL;
+
+/*******************************************************************************
+ * Function Name: app_event_loop_task
+ *******************************************************************************
+ * Summary:
+ *   Task that runs the publisher, subscriber and pasco2 configuration
+ *   handlers. The events are handled one at a time in the order they were
+ *   queued, so a publish waits for a subscribe or a configuration that is in
+ *   progress.
+ *
+ * Parameters:
+ *   pvParameters: Task parameter defined during task creation (unused)
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void app_event_loop_task(void *pvParameters)
+{
+    QueueSetHandle_t event_set;
+    QueueSetMemberHandle_t event_queue;
+    TickType_t wait_ticks;
+    publisher_data_t publisher_q_data;
+    subscriber_data_t subscriber_q_data;
+
+    /* To avoid compiler warnings */
+    (void)pvParameters;
+
+    /* The same initialization as the tasks that are replaced */
+    subscriber_init();
+    publisher_init();
+    pasco2_config_init();
+
+    event_set = xQueueCreateSet(APP_EVENT_LOOP_SET_LENGTH);
+    if ((event_set == NULL) ||
+        (pdPASS != xQueueAddToSet(publisher_task_q, event_set)) ||
+        (pdPASS != xQueueAddToSet(subscriber_task_q, event_set)) ||
+        (pdPASS != xQueueAddToSet(pasco2_config_q, event_set)))
+    {
+        printf("Event loop queue set creation failed... Task suspend\n\n");
+        vTaskSuspend(NULL);
+    }
+
+    while (true)
+    {
+        /* Wake up for the next publish from the redelivery ring and for
+         * the next subscribe attempt too
+         */
+        wait_ticks = publisher_wait_ticks();
+        if (subscriber_wait_ticks() < wait_ticks)
+        {
+            wait_ticks = subscriber_wait_ticks();
+        }
+        event_queue = xQueueSelectFromSet(event_set, wait_ticks);
+
+        if ((event_queue == publisher_task_q) &&
+            (pdTRUE == xQueueReceive(publisher_task_q, &publisher_q_data, 0)))
+        {
+            publisher_handle(&publisher_q_data);
+        }
+        else if ((event_queue == subscriber_task_q) &&
+                 (pdTRUE == xQueueReceive(subscriber_task_q, &subscriber_q_data, 0)))
+        {
+            subscriber_handle(&subscriber_q_data);
+        }
+        else if (event_queue == pasco2_config_q)
+        {
+            pasco2_config_handle();
+        }
+        subscriber_retry_step();
+        publisher_flush_step();
+    }
+}
+
+#endif /* APP_EVENT_LOOP_ENABLED */
+
+/* [] END OF FILE */
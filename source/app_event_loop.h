@@ -0,0 +1,61 @@
+/******************************************************************************
+ * File Name:   app_event_loop.h
+ *
+ * Description: This file contains the function prototypes and constants of the
+ *              event loop task.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stack_size_config.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Set to 1 (or build with EVENT_LOOP=1) to run the publisher, the subscriber
+ * and the pasco2 configuration as handlers of one event loop task instead of
+ * three tasks. The MQTT client task and the sensor task are kept.
+ */
+#ifndef APP_EVENT_LOOP_ENABLED
+#define APP_EVENT_LOOP_ENABLED          (0)
+#endif
+
+#define APP_EVENT_LOOP_TASK_NAME        "EVENT LOOP TASK"
+#define APP_EVENT_LOOP_TASK_PRIORITY    (2)
+#ifndef APP_EVENT_LOOP_TASK_STACK_SIZE
+#define APP_EVENT_LOOP_TASK_STACK_SIZE  (1024 * 2)
+#endif
+
+/*******************************************************************************
+ * Global Variables
+ *******************************************************************************/
+extern TaskHandle_t app_event_loop_task_handle;
+
+/*******************************************************************************
+ * Functions
+ *******************************************************************************/
+void app_event_loop_task(void *pvParameters);
+
+/* [] END OF FILE */
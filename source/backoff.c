@@ -0,0 +1,106 @@
+/******************************************************************************
+ * File Name:   backoff.c
+ *
+ * Description: This file contains the retry delay calculation used for the
+ *              Wi-Fi and MQTT reconnections. Each delay is drawn at random
+ *              between the base delay and three times the previous delay,
+ *              capped at a maximum. The random spread keeps a fleet of
+ *              devices from reconnecting in lockstep after a broker restart.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#include "backoff.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Growth factor of the upper bound of the next delay */
+#define BACKOFF_GROWTH_FACTOR   (3u)
+
+/*******************************************************************************
+ * Function Name: backoff_init
+ *******************************************************************************
+ * Summary:
+ *   Initializes the backoff with its delay range.
+ *
+ * Parameters:
+ *   backoff: backoff state
+ *   base_ms: shortest delay in milliseconds
+ *   cap_ms: longest delay in milliseconds, not lower than 'base_ms'
+ *   seed: seed of the random sequence, e.g. prng_device_seed()
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void backoff_init(backoff_t *backoff, uint32_t base_ms, uint32_t cap_ms, uint32_t seed)
+{
+    prng_init(&backoff->prng, seed);
+    backoff->base_ms = base_ms;
+    backoff->cap_ms = cap_ms;
+    backoff_reset(backoff);
+}
+
+/*******************************************************************************
+ * Function Name: backoff_reset
+ *******************************************************************************
+ * Summary:
+ *   Restarts the delays at the base delay, e.g. after a successful
+ *   connection.
+ *
+ * Parameters:
+ *   backoff: backoff state
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void backoff_reset(backoff_t *backoff)
+{
+    backoff->delay_ms = backoff->base_ms;
+}
+
+/*******************************************************************************
+ * Function Name: backoff_next_ms
+ *******************************************************************************
+ * Summary:
+ *   Returns the delay before the next retry.
+ *
+ * Parameters:
+ *   backoff: backoff state
+ *
+ * Return:
+ *   uint32_t: delay in milliseconds
+ ******************************************************************************/
+uint32_t backoff_next_ms(backoff_t *backoff)
+{
+    uint32_t upper_ms = backoff->cap_ms;
+
+    if (backoff->delay_ms < (backoff->cap_ms / BACKOFF_GROWTH_FACTOR))
+    {
+        upper_ms = backoff->delay_ms * BACKOFF_GROWTH_FACTOR;
+    }
+
+    backoff->delay_ms = prng_range(&backoff->prng, backoff->base_ms, upper_ms);
+
+    return backoff->delay_ms;
+}
+
+/* [] END OF FILE */
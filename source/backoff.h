@@ -0,0 +1,52 @@
+/******************************************************************************
+ * File Name:   backoff.h
+ *
+ * Description: This file is the public interface of backoff.c
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "prng.h"
+
+/*******************************************************************************
+ * Typedefines
+ ******************************************************************************/
+/* State of a decorrelated-jitter exponential backoff */
+typedef struct
+{
+    prng_t prng;            /* Per-device random sequence */
+    uint32_t base_ms;       /* Shortest delay */
+    uint32_t cap_ms;        /* Longest delay */
+    uint32_t delay_ms;      /* Last delay returned */
+} backoff_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+void backoff_init(backoff_t *backoff, uint32_t base_ms, uint32_t cap_ms, uint32_t seed);
+void backoff_reset(backoff_t *backoff);
+uint32_t backoff_next_ms(backoff_t *backoff);
+
+/* [] END OF FILE */
@@ -0,0 +1,205 @@
+/******************************************************************************
+ * File Name:   broker_select.c
+ *
+ * Description: This file selects the MQTT broker of each connect attempt from
+ *              the configured brokers by their priority, measured connect latency
+ *              and recent failures, so that the client fails over to another broker
+ *              after a failure.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#include <stdio.h>
+
+#include "broker_select.h"
+#include "time_sync.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Weight of a new latency measurement in the smoothed latency, as a shift */
+#define BROKER_LATENCY_SMOOTHING_SHIFT  (2u)
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static broker_stats_t broker_stats[BROKER_SELECT_MAX_ENDPOINTS];
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+static uint32_t broker_endpoints_used(void);
+static void broker_decay_failures(broker_stats_t *stats, uint64_t now_ms);
+
+/*******************************************************************************
+ * Function Name: broker_select_next
+ *******************************************************************************
+ * Summary:
+ *   Selects the broker of the next connect attempt. The score of a broker is
+ *   its priority and its recent failures weighted in milliseconds, plus its
+ *   smoothed connect latency. A broker without a measured latency scores no
+ *   latency, so each broker of the best priority is tried once. The broker
+ *   with the lowest score is selected, the first configured one on a tie.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   const mqtt_broker_endpoint_t *: broker to connect to
+ ******************************************************************************/
+const mqtt_broker_endpoint_t *broker_select_next(void)
+{
+    const uint64_t now_ms = time_sync_get_mono_ms();
+    const uint32_t count = broker_endpoints_used();
+    uint32_t best = 0;
+    uint32_t best_score = UINT32_MAX;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        broker_stats_t *stats = &broker_stats[i];
+        uint32_t score;
+
+        broker_decay_failures(stats, now_ms);
+        score = (broker_endpoints[i].priority * BROKER_PRIORITY_WEIGHT_MS) +
+                (stats->failures * BROKER_FAILURE_PENALTY_MS) +
+                stats->latency_ms;
+
+        if (score < best_score)
+        {
+            best = i;
+            best_score = score;
+        }
+    }
+
+    return &broker_endpoints[best];
+}
+
+/*******************************************************************************
+ * Function Name: broker_select_report
+ *******************************************************************************
+ * Summary:
+ *   Updates the measurements of a broker with the result of a connect
+ *   attempt. A failure raises the failure score, a success clears it and
+ *   adds the latency to the smoothed latency.
+ *
+ * Parameters:
+ *   endpoint: broker returned by broker_select_next()
+ *   connected: true if the connection was established
+ *   latency_ms: duration of the successful connect, without the DNS lookup
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void broker_select_report(const mqtt_broker_endpoint_t *endpoint, bool connected, uint32_t latency_ms)
+{
+    const uint32_t index = (uint32_t)(endpoint - broker_endpoints);
+    broker_stats_t *stats;
+
+    if (index >= broker_endpoints_used())
+    {
+        return;
+    }
+    stats = &broker_stats[index];
+
+    if (!connected)
+    {
+        if (stats->failures < BROKER_FAILURE_SCORE_MAX)
+        {
+            stats->failures++;
+        }
+        stats->last_failure_ms = time_sync_get_mono_ms();
+        return;
+    }
+
+    stats->failures = 0;
+    stats->connects++;
+    if (stats->latency_ms == 0u)
+    {
+        stats->latency_ms = latency_ms;
+    }
+    else
+    {
+        stats->latency_ms = stats->latency_ms - (stats->latency_ms >> BROKER_LATENCY_SMOOTHING_SHIFT) +
+                            (latency_ms >> BROKER_LATENCY_SMOOTHING_SHIFT);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: broker_select_get_stats
+ *******************************************************************************
+ * Summary:
+ *   Returns the measurements of a broker, e.g. for diagnostics.
+ *
+ * Parameters:
+ *   endpoint: one of the configured brokers
+ *
+ * Return:
+ *   const broker_stats_t *: measurements, NULL if the broker is not tracked
+ ******************************************************************************/
+const broker_stats_t *broker_select_get_stats(const mqtt_broker_endpoint_t *endpoint)
+{
+    const uint32_t index = (uint32_t)(endpoint - broker_endpoints);
+
+    return (index < broker_endpoints_used()) ? &broker_stats[index] : NULL;
+}
+
+/*******************************************************************************
+ * Function Name: broker_endpoints_used
+ *******************************************************************************
+ * Summary:
+ *   Returns the number of configured brokers that are tracked.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   uint32_t: number of brokers
+ ******************************************************************************/
+static uint32_t broker_endpoints_used(void)
+{
+    return (broker_endpoint_count < BROKER_SELECT_MAX_ENDPOINTS) ? broker_endpoint_count
+                                                                 : BROKER_SELECT_MAX_ENDPOINTS;
+}
+
+/*******************************************************************************
+ * Function Name: broker_decay_failures
+ *******************************************************************************
+ * Summary:
+ *   Forgets one failure of a broker for every BROKER_FAILURE_DECAY_MS
+ *   without a failure.
+ *
+ * Parameters:
+ *   stats: measurements of the broker
+ *   now_ms: current monotonic time
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void broker_decay_failures(broker_stats_t *stats, uint64_t now_ms)
+{
+    while ((stats->failures > 0u) && ((now_ms - stats->last_failure_ms) >= BROKER_FAILURE_DECAY_MS))
+    {
+        stats->failures--;
+        stats->last_failure_ms += BROKER_FAILURE_DECAY_MS;
+    }
+}
+
+/* [] END OF FILE */
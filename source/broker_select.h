@@ -0,0 +1,73 @@
+/******************************************************************************
+ * File Name:   broker_select.h
+ *
+ * Description: This file contains the function prototypes of the MQTT broker
+ *              selection.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "mqtt_client_config.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Most brokers that are tracked, further configured brokers are ignored */
+#define BROKER_SELECT_MAX_ENDPOINTS     (4u)
+
+/* Score added per priority level and per recent failure, in milliseconds of
+ * connect latency. One failure outweighs one priority level, so the client
+ * fails over to the broker of the next priority level on the next attempt.
+ */
+#define BROKER_PRIORITY_WEIGHT_MS       (10000u)
+#define BROKER_FAILURE_PENALTY_MS       (15000u)
+
+/* A failure is forgotten after this time without a failure, so that the
+ * client returns to the preferred broker on a later reconnect.
+ */
+#define BROKER_FAILURE_DECAY_MS         (10u * 60u * 1000u)
+#define BROKER_FAILURE_SCORE_MAX        (8u)
+
+/*******************************************************************************
+ * Typedefines
+ ******************************************************************************/
+/* Measurements of one broker */
+typedef struct
+{
+    uint32_t latency_ms;        /* Smoothed connect latency, 0 if unknown */
+    uint32_t failures;          /* Recent failures */
+    uint64_t last_failure_ms;   /* Monotonic time of the last failure */
+    uint32_t connects;          /* Successful connections */
+} broker_stats_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+const mqtt_broker_endpoint_t *broker_select_next(void);
+void broker_select_report(const mqtt_broker_endpoint_t *endpoint, bool connected, uint32_t latency_ms);
+const broker_stats_t *broker_select_get_stats(const mqtt_broker_endpoint_t *endpoint);
+
+/* [] END OF FILE */
@@ -0,0 +1,151 @@
+/******************************************************************************
+ * File Name:   co2_analytics.c
+ *
+ * Description: This file contains the edge analytics stage that runs after
+ *              each CO2 acquisition. An EWMA baseline with z-score outlier
+ *              detection and a sustained threshold detector turn the raw
+ *              samples into alert events.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#include "co2_analytics.h"
+
+/*******************************************************************************
+ * Function Name: co2_analytics_init
+ *******************************************************************************
+ * Summary:
+ *   Resets the detector state.
+ *
+ * Parameters:
+ *   analytics: detector state
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void co2_analytics_init(co2_analytics_t *analytics)
+{
+    *analytics = (co2_analytics_t){0};
+}
+
+/*******************************************************************************
+ * Function Name: co2_analytics_update
+ *******************************************************************************
+ * Summary:
+ *   Runs all detectors on a new CO2 value and updates the baseline. When
+ *   several detectors fire on the same sample, the sustained threshold
+ *   transitions are reported first as they are rarer than outliers.
+ *
+ * Parameters:
+ *   analytics: detector state
+ *   ppm: new CO2 value
+ *   now_ms: monotonic time of the CO2 value in milliseconds
+ *
+ * Return:
+ *   co2_alert_t: alert raised by this sample, CO2_ALERT_NONE if none
+ ******************************************************************************/
+co2_alert_t co2_analytics_update(co2_analytics_t *analytics, uint16_t ppm, uint64_t now_ms)
+{
+    co2_alert_t alert = CO2_ALERT_NONE;
+
+    /* Sustained threshold detector */
+    if (ppm > CO2_ANALYTICS_SUSTAINED_PPM)
+    {
+        if (!analytics->above)
+        {
+            analytics->above = true;
+            analytics->above_since_ms = now_ms;
+        }
+        if (!analytics->sustained_active && ((now_ms - analytics->above_since_ms) >= CO2_ANALYTICS_SUSTAINED_MS))
+        {
+            analytics->sustained_active = true;
+            alert = CO2_ALERT_SUSTAINED_HIGH;
+        }
+    }
+    else
+    {
+        analytics->above = false;
+        if (analytics->sustained_active && (ppm < (CO2_ANALYTICS_SUSTAINED_PPM - CO2_ANALYTICS_SUSTAINED_HYST_PPM)))
+        {
+            analytics->sustained_active = false;
+            alert = CO2_ALERT_SUSTAINED_CLEARED;
+        }
+    }
+
+    /* The first sample initializes the baseline */
+    if (analytics->count == 0U)
+    {
+        analytics->mean_x16 = (int32_t)ppm << 4;
+        analytics->count = 1U;
+        return alert;
+    }
+
+    /* Z-score outlier detector, compared squared to avoid the square root */
+    const int32_t diff = (int32_t)ppm - (analytics->mean_x16 >> 4);
+    const int64_t diff_sq = (int64_t)diff * diff;
+    const int64_t min_variance = (int64_t)CO2_ANALYTICS_MIN_STDDEV_PPM * CO2_ANALYTICS_MIN_STDDEV_PPM;
+    const int64_t variance = (analytics->variance > min_variance) ? analytics->variance : min_variance;
+
+    if ((analytics->count >= CO2_ANALYTICS_WARMUP_SAMPLES) && (alert == CO2_ALERT_NONE) &&
+        (diff_sq > ((int64_t)CO2_ANALYTICS_Z_THRESHOLD * CO2_ANALYTICS_Z_THRESHOLD * variance)))
+    {
+        alert = CO2_ALERT_OUTLIER;
+    }
+
+    /* Update the EWMA baseline and variance */
+    analytics->mean_x16 += (((int32_t)ppm << 4) - analytics->mean_x16) >> CO2_ANALYTICS_EWMA_SHIFT;
+    analytics->variance += (diff_sq - analytics->variance) >> CO2_ANALYTICS_EWMA_SHIFT;
+    if (analytics->count < CO2_ANALYTICS_WARMUP_SAMPLES)
+    {
+        analytics->count++;
+    }
+
+    return alert;
+}
+
+/*******************************************************************************
+ * Function Name: co2_analytics_alert_name
+ *******************************************************************************
+ * Summary:
+ *   Returns the short name of an alert used in the alert payload.
+ *
+ * Parameters:
+ *   alert: alert event
+ *
+ * Return:
+ *   const char *: name of the alert
+ ******************************************************************************/
+const char *co2_analytics_alert_name(co2_alert_t alert)
+{
+    switch (alert)
+    {
+        case CO2_ALERT_OUTLIER:
+            return "outlier";
+        case CO2_ALERT_SUSTAINED_HIGH:
+            return "high";
+        case CO2_ALERT_SUSTAINED_CLEARED:
+            return "cleared";
+        default:
+            return "none";
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,87 @@
+/******************************************************************************
+ * File Name:   co2_analytics.h
+ *
+ * Description: This file is the public interface of co2_analytics.c
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Weight of a new sample in the EWMA baseline: alpha = 1 / 2^shift */
+#define CO2_ANALYTICS_EWMA_SHIFT            (4)
+
+/* Number of samples needed before the baseline is used for outlier detection */
+#define CO2_ANALYTICS_WARMUP_SAMPLES        (16U)
+
+/* A sample is an outlier when it is more than this many standard deviations
+ * away from the baseline. The standard deviation is never assumed smaller
+ * than 'CO2_ANALYTICS_MIN_STDDEV_PPM', so sensor noise in a stable room does
+ * not raise alerts.
+ */
+#define CO2_ANALYTICS_Z_THRESHOLD           (4)
+#define CO2_ANALYTICS_MIN_STDDEV_PPM        (15)
+
+/* Sustained high CO2 alert: raised when the value stays above the threshold
+ * for the given duration, cleared when it drops below the threshold minus
+ * the hysteresis.
+ */
+#define CO2_ANALYTICS_SUSTAINED_PPM         (1000U)
+#define CO2_ANALYTICS_SUSTAINED_HYST_PPM    (50U)
+#define CO2_ANALYTICS_SUSTAINED_MS          (10U * 60U * 1000U)
+
+/*******************************************************************************
+ * Typedefines
+ ******************************************************************************/
+/* Alert events raised by the detectors */
+typedef enum
+{
+    CO2_ALERT_NONE,
+    CO2_ALERT_OUTLIER,
+    CO2_ALERT_SUSTAINED_HIGH,
+    CO2_ALERT_SUSTAINED_CLEARED
+} co2_alert_t;
+
+/* Detector state. Fixed size, O(1) per sample. */
+typedef struct
+{
+    int32_t mean_x16;           /* EWMA baseline, ppm * 16 */
+    int64_t variance;           /* EWMA variance, ppm^2 */
+    uint32_t count;             /* Samples seen, saturates at warm-up */
+    uint64_t above_since_ms;    /* Time the value first exceeded the threshold */
+    bool above;                 /* Value is above the sustained threshold */
+    bool sustained_active;      /* Sustained high alert was raised */
+} co2_analytics_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+void co2_analytics_init(co2_analytics_t *analytics);
+co2_alert_t co2_analytics_update(co2_analytics_t *analytics, uint16_t ppm, uint64_t now_ms);
+const char *co2_analytics_alert_name(co2_alert_t alert);
+
+/* [] END OF FILE */
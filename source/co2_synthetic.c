@@ -0,0 +1,116 @@
+/******************************************************************************
+ * File Name:   co2_synthetic.c
+ *
+ * Description: This file contains a synthetic CO2 generator that replaces the
+ *              PAS CO2 sensor for broker and backend load tests. It models a
+ *              room with random occupancy phases and ventilation, so that a
+ *              fleet of boards without sensors produces realistic, different
+ *              and reproducible data.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#include "co2_synthetic.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Fixed-point scale of the room level */
+#define LEVEL_SCALE_SHIFT   (4)
+
+/* Range of the generated values */
+#define CO2_SYNTHETIC_MIN_PPM   (0)
+#define CO2_SYNTHETIC_MAX_PPM   (32000)
+
+/*******************************************************************************
+ * Function Name: co2_synthetic_init
+ *******************************************************************************
+ * Summary:
+ *   Starts the generator with an empty room at the outdoor level.
+ *
+ * Parameters:
+ *   synthetic: generator state
+ *   seed: seed of the random sequence, e.g. prng_device_seed()
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void co2_synthetic_init(co2_synthetic_t *synthetic, uint32_t seed)
+{
+    prng_init(&synthetic->prng, seed);
+    synthetic->level_x16 = CO2_SYNTHETIC_OUTDOOR_PPM << LEVEL_SCALE_SHIFT;
+    synthetic->occupants = 0U;
+    synthetic->phase_remaining_s = 0U;
+}
+
+/*******************************************************************************
+ * Function Name: co2_synthetic_next
+ *******************************************************************************
+ * Summary:
+ *   Advances the room model by the elapsed time and returns a noisy sample.
+ *   Occupants add CO2 at a constant rate while ventilation pulls the level
+ *   back to the outdoor level with the ventilation time constant.
+ *
+ * Parameters:
+ *   synthetic: generator state
+ *   elapsed_s: time since the previous sample in seconds
+ *
+ * Return:
+ *   uint16_t: CO2 value in ppm
+ ******************************************************************************/
+uint16_t co2_synthetic_next(co2_synthetic_t *synthetic, uint32_t elapsed_s)
+{
+    if (synthetic->phase_remaining_s <= elapsed_s)
+    {
+        /* Start a new phase, half of the phases leave the room empty */
+        synthetic->occupants = ((prng_next(&synthetic->prng) & 1U) != 0U)
+                               ? prng_range(&synthetic->prng, 1U, CO2_SYNTHETIC_MAX_OCCUPANTS) : 0U;
+        synthetic->phase_remaining_s = prng_range(&synthetic->prng, CO2_SYNTHETIC_PHASE_MIN_S,
+                                                  CO2_SYNTHETIC_PHASE_MAX_S);
+    }
+    else
+    {
+        synthetic->phase_remaining_s -= elapsed_s;
+    }
+
+    const int32_t rise_x16 = (int32_t)((synthetic->occupants * CO2_SYNTHETIC_PPM_PER_OCCUPANT_MIN * elapsed_s
+                                        << LEVEL_SCALE_SHIFT) / 60U);
+    const int32_t excess_x16 = synthetic->level_x16 - (CO2_SYNTHETIC_OUTDOOR_PPM << LEVEL_SCALE_SHIFT);
+    const int32_t decay_x16 = (int32_t)(((int64_t)excess_x16 * (int32_t)elapsed_s) / CO2_SYNTHETIC_VENTILATION_TAU_S);
+
+    synthetic->level_x16 += rise_x16 - decay_x16;
+
+    int32_t ppm = (synthetic->level_x16 >> LEVEL_SCALE_SHIFT) +
+                  (int32_t)prng_range(&synthetic->prng, 0U, 2U * CO2_SYNTHETIC_NOISE_PPM) -
+                  (int32_t)CO2_SYNTHETIC_NOISE_PPM;
+    if (ppm < CO2_SYNTHETIC_MIN_PPM)
+    {
+        ppm = CO2_SYNTHETIC_MIN_PPM;
+    }
+    else if (ppm > CO2_SYNTHETIC_MAX_PPM)
+    {
+        ppm = CO2_SYNTHETIC_MAX_PPM;
+    }
+
+    return (uint16_t)ppm;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,71 @@
+/******************************************************************************
+ * File Name:   co2_synthetic.h
+ *
+ * Description: This file is the public interface of co2_synthetic.c
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "prng.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Outdoor CO2 level the room decays to when it is empty */
+#define CO2_SYNTHETIC_OUTDOOR_PPM           (420)
+
+/* CO2 rise per occupant and minute, and the maximum number of occupants */
+#define CO2_SYNTHETIC_PPM_PER_OCCUPANT_MIN  (8)
+#define CO2_SYNTHETIC_MAX_OCCUPANTS         (10U)
+
+/* Ventilation time constant of the room in seconds */
+#define CO2_SYNTHETIC_VENTILATION_TAU_S     (1800)
+
+/* Range of the duration of one occupancy phase in seconds */
+#define CO2_SYNTHETIC_PHASE_MIN_S           (10U * 60U)
+#define CO2_SYNTHETIC_PHASE_MAX_S           (90U * 60U)
+
+/* Peak amplitude of the sensor noise added to each sample */
+#define CO2_SYNTHETIC_NOISE_PPM             (5U)
+
+/*******************************************************************************
+ * Typedefines
+ ******************************************************************************/
+/* State of the synthetic CO2 generator */
+typedef struct
+{
+    prng_t prng;                    /* Per-device random sequence */
+    int32_t level_x16;              /* Room CO2 level, ppm * 16 */
+    uint32_t occupants;             /* Occupants in the current phase */
+    uint32_t phase_remaining_s;     /* Time left in the current phase */
+} co2_synthetic_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+void co2_synthetic_init(co2_synthetic_t *synthetic, uint32_t seed);
+uint16_t co2_synthetic_next(co2_synthetic_t *synthetic, uint32_t elapsed_s);
+
+/* [] END OF FILE */
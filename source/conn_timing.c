@@ -0,0 +1,383 @@
+/******************************************************************************
+ * File Name:   conn_timing.c
+ *
+ * Description: This file times the phases of each Wi-Fi and MQTT connection
+ *              setup with a microsecond timer, keeps the last breakdowns in RAM
+ *              and publishes each breakdown on the diagnostics topic.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "cyhal.h"
+
+/* FreeRTOS header files */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* LwIP header files */
+#include "lwip/netif.h"
+#include "lwip/tcpip.h"
+
+#include "conn_timing.h"
+#include "publisher_task.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* The microsecond timer runs freely over its full 32-bit range and wraps
+ * after about 71 minutes, longer than any single phase.
+ */
+#define CONN_TIMER_CLOCK_HZ     (1000000u)
+#define CONN_TIMER_PERIOD       (0xFFFFFFFFu)
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+/* Free-running microsecond timer, only read after a successful init */
+static cyhal_timer_t conn_timer;
+static bool conn_timer_ready = false;
+
+/* Connection setup in progress and the start times of its running phases */
+static conn_timing_record_t current;
+static uint32_t current_begin_us;
+static uint32_t phase_start_us[CONN_PHASE_COUNT];
+static uint32_t phases_running;
+static bool in_progress = false;
+
+/* Completed connection setups, oldest overwritten first */
+static conn_timing_record_t history[CONN_TIMING_HISTORY_LENGTH];
+static uint32_t history_count = 0;
+
+/* The last breakdown could not be queued for publishing yet */
+static bool publish_pending = false;
+
+#if LWIP_NETIF_EXT_STATUS_CALLBACK
+NETIF_DECLARE_EXT_CALLBACK(conn_timing_netif_cb)
+#endif
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+static uint32_t conn_timing_now_us(void);
+
+#if LWIP_NETIF_EXT_STATUS_CALLBACK
+/*******************************************************************************
+ * Function Name: conn_timing_netif_callback
+ *******************************************************************************
+ * Summary:
+ *   lwIP callback of the network interface changes. The link of the Wi-Fi
+ *   interface comes up when the association completes, which is where the
+ *   DHCP phase starts. Without this callback, the association phase covers
+ *   the whole Wi-Fi connect.
+ *
+ * Parameters:
+ *   netif: network interface that changed (unused)
+ *   reason: bit mask of the changes
+ *   args: details of the changes
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void conn_timing_netif_callback(struct netif *netif, netif_nsc_reason_t reason,
+                                       const netif_ext_callback_args_t *args)
+{
+    (void)netif;
+
+    if (((reason & LWIP_NSC_LINK_CHANGED) != 0u) && (args->link_changed.state != 0u) &&
+        ((phases_running & (1u << CONN_PHASE_WIFI_ASSOC)) != 0u))
+    {
+        conn_timing_end(CONN_PHASE_WIFI_ASSOC);
+        conn_timing_start(CONN_PHASE_DHCP);
+    }
+}
+#endif /* LWIP_NETIF_EXT_STATUS_CALLBACK */
+
+/*******************************************************************************
+ * Function Name: conn_timing_init
+ *******************************************************************************
+ * Summary:
+ *   Starts the microsecond timer and registers for the network interface
+ *   changes. The RTOS tick is used if no timer is available.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void conn_timing_init(void)
+{
+    const cyhal_timer_cfg_t conn_timer_cfg =
+    {
+        .compare_value = 0,                 /* Timer compare value, not used */
+        .period = CONN_TIMER_PERIOD,        /* Defines the timer period */
+        .direction = CYHAL_TIMER_DIR_UP,    /* Timer counts up */
+        .is_compare = false,                /* Don't use compare mode */
+        .is_continuous = true,              /* Run timer indefinitely */
+        .value = 0                          /* Initial value of counter */
+    };
+
+    if ((CY_RSLT_SUCCESS == cyhal_timer_init(&conn_timer, NC, NULL)) &&
+        (CY_RSLT_SUCCESS == cyhal_timer_configure(&conn_timer, &conn_timer_cfg)) &&
+        (CY_RSLT_SUCCESS == cyhal_timer_set_frequency(&conn_timer, CONN_TIMER_CLOCK_HZ)) &&
+        (CY_RSLT_SUCCESS == cyhal_timer_start(&conn_timer)))
+    {
+        conn_timer_ready = true;
+    }
+    else
+    {
+        printf("Connection timing: no timer available, using the RTOS tick\n");
+    }
+
+#if LWIP_NETIF_EXT_STATUS_CALLBACK
+    LOCK_TCPIP_CORE();
+    netif_add_ext_callback(&conn_timing_netif_cb, conn_timing_netif_callback);
+    UNLOCK_TCPIP_CORE();
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: conn_timing_begin
+ *******************************************************************************
+ * Summary:
+ *   Starts timing a new connection setup, e.g. on boot or after a lost
+ *   connection. An unfinished setup is discarded.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void conn_timing_begin(void)
+{
+    taskENTER_CRITICAL();
+    memset(&current, 0, sizeof(current));
+    phases_running = 0;
+    current_begin_us = conn_timing_now_us();
+    in_progress = true;
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+ * Function Name: conn_timing_attempt
+ *******************************************************************************
+ * Summary:
+ *   Counts a Wi-Fi or MQTT connection attempt of the current setup.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void conn_timing_attempt(void)
+{
+    current.attempts++;
+}
+
+/*******************************************************************************
+ * Function Name: conn_timing_start
+ *******************************************************************************
+ * Summary:
+ *   Marks the start of a phase. A phase that is run again, e.g. on a retry,
+ *   restarts its timing.
+ *
+ * Parameters:
+ *   phase: phase that starts
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void conn_timing_start(conn_phase_t phase)
+{
+    const uint32_t now_us = conn_timing_now_us();
+
+    taskENTER_CRITICAL();
+    phase_start_us[phase] = now_us;
+    phases_running |= (1u << phase);
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+ * Function Name: conn_timing_end
+ *******************************************************************************
+ * Summary:
+ *   Marks the end of a phase and stores its duration. Does nothing if the
+ *   phase is not running.
+ *
+ * Parameters:
+ *   phase: phase that ends
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void conn_timing_end(conn_phase_t phase)
+{
+    const uint32_t now_us = conn_timing_now_us();
+
+    taskENTER_CRITICAL();
+    if ((phases_running & (1u << phase)) != 0u)
+    {
+        current.phase_us[phase] = now_us - phase_start_us[phase];
+        phases_running &= ~(1u << phase);
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+ * Function Name: conn_timing_complete
+ *******************************************************************************
+ * Summary:
+ *   Completes the current connection setup once the subscription is
+ *   acknowledged. The breakdown is added to the history, printed and
+ *   published on the diagnostics topic.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void conn_timing_complete(void)
+{
+    const uint32_t now_us = conn_timing_now_us();
+    conn_timing_record_t *record;
+
+    taskENTER_CRITICAL();
+    if (!in_progress)
+    {
+        taskEXIT_CRITICAL();
+        return;
+    }
+    in_progress = false;
+    current.total_us = now_us - current_begin_us;
+    record = &history[history_count % CONN_TIMING_HISTORY_LENGTH];
+    *record = current;
+    history_count++;
+    publish_pending = true;
+    taskEXIT_CRITICAL();
+
+    printf("Connection setup in %lu us after %lu attempts: assoc %lu us, dhcp %lu us, "
+           "dns %lu us, mqtt %lu us, suback %lu us\n",
+           (unsigned long)record->total_us, (unsigned long)record->attempts,
+           (unsigned long)record->phase_us[CONN_PHASE_WIFI_ASSOC],
+           (unsigned long)record->phase_us[CONN_PHASE_DHCP],
+           (unsigned long)record->phase_us[CONN_PHASE_DNS],
+           (unsigned long)record->phase_us[CONN_PHASE_MQTT_CONNECT],
+           (unsigned long)record->phase_us[CONN_PHASE_SUBSCRIBE]);
+
+    conn_timing_publish_pending();
+}
+
+/*******************************************************************************
+ * Function Name: conn_timing_publish_pending
+ *******************************************************************************
+ * Summary:
+ *   Queues the last breakdown on the diagnostics topic if it was not
+ *   published yet. The publisher task calls this once it runs, as it is
+ *   created after the first connection setup completed. The phases are
+ *   published in milliseconds in the order of conn_phase_t.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void conn_timing_publish_pending(void)
+{
+    const conn_timing_record_t *record = conn_timing_get(0);
+    publisher_data_t publisher_q_data;
+
+    if (!publish_pending || (record == NULL) || (publisher_task_q == NULL))
+    {
+        return;
+    }
+
+    publisher_q_data.cmd = PUBLISH_MQTT_DIAG;
+    publisher_q_data.seq = 0;
+    snprintf(publisher_q_data.data, sizeof(publisher_q_data.data),
+             "{\"conn_ms\":[%lu,%lu,%lu,%lu,%lu],\"total_ms\":%lu,\"n\":%lu}",
+             (unsigned long)(record->phase_us[CONN_PHASE_WIFI_ASSOC] / 1000u),
+             (unsigned long)(record->phase_us[CONN_PHASE_DHCP] / 1000u),
+             (unsigned long)(record->phase_us[CONN_PHASE_DNS] / 1000u),
+             (unsigned long)(record->phase_us[CONN_PHASE_MQTT_CONNECT] / 1000u),
+             (unsigned long)(record->phase_us[CONN_PHASE_SUBSCRIBE] / 1000u),
+             (unsigned long)(record->total_us / 1000u),
+             (unsigned long)record->attempts);
+
+    if (pdPASS == publisher_post(&publisher_q_data))
+    {
+        publish_pending = false;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: conn_timing_get
+ *******************************************************************************
+ * Summary:
+ *   Returns a completed connection setup from the history.
+ *
+ * Parameters:
+ *   age: 0 for the last setup, 1 for the one before, and so on
+ *
+ * Return:
+ *   const conn_timing_record_t *: breakdown, NULL if not in the history
+ ******************************************************************************/
+const conn_timing_record_t *conn_timing_get(uint32_t age)
+{
+    if ((age >= history_count) || (age >= CONN_TIMING_HISTORY_LENGTH))
+    {
+        return NULL;
+    }
+
+    return &history[(history_count - 1u - age) % CONN_TIMING_HISTORY_LENGTH];
+}
+
+/*******************************************************************************
+ * Function Name: conn_timing_now_us
+ *******************************************************************************
+ * Summary:
+ *   Reads the microsecond timer. The differences of two readings are valid
+ *   across the wrap of the timer.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   uint32_t: time in microseconds
+ ******************************************************************************/
+static uint32_t conn_timing_now_us(void)
+{
+    if (conn_timer_ready)
+    {
+        return cyhal_timer_read(&conn_timer);
+    }
+
+    return (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS * 1000u);
+}
+
+/* [] END OF FILE */
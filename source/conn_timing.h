@@ -0,0 +1,76 @@
+/******************************************************************************
+ * File Name:   conn_timing.h
+ *
+ * Description: This file contains the function prototypes and types of the
+ *              connection setup time breakdown.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Number of connection setups kept in RAM */
+#define CONN_TIMING_HISTORY_LENGTH  (8u)
+
+/*******************************************************************************
+ * Typedefines
+ ******************************************************************************/
+/* Phases of a connection setup, in the order they are run */
+typedef enum
+{
+    CONN_PHASE_WIFI_ASSOC,      /* Wi-Fi authentication and association */
+    CONN_PHASE_DHCP,            /* IP address lease after the association */
+    CONN_PHASE_DNS,             /* Resolution of the broker hostname */
+    CONN_PHASE_MQTT_CONNECT,    /* TCP connect, TLS handshake and CONNACK */
+    CONN_PHASE_SUBSCRIBE,       /* SUBSCRIBE until the SUBACK */
+    CONN_PHASE_COUNT
+} conn_phase_t;
+
+/* Time breakdown of one connection setup. The phases hold the duration of
+ * their last attempt, zero if the phase was skipped, e.g. the Wi-Fi phases
+ * on an MQTT reconnect. The total includes the failed attempts and the
+ * backoff delays.
+ */
+typedef struct
+{
+    uint32_t phase_us[CONN_PHASE_COUNT];
+    uint32_t total_us;
+    uint32_t attempts;
+} conn_timing_record_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+void conn_timing_init(void);
+void conn_timing_begin(void);
+void conn_timing_attempt(void);
+void conn_timing_start(conn_phase_t phase);
+void conn_timing_end(conn_phase_t phase);
+void conn_timing_complete(void);
+void conn_timing_publish_pending(void);
+const conn_timing_record_t *conn_timing_get(uint32_t age);
+
+/* [] END OF FILE */
@@ -0,0 +1,178 @@
+/******************************************************************************
+ * File Name:   dns_cache.c
+ *
+ * Description: This file caches the resolved addresses of hostnames, so that a
+ *              reconnect does not wait for a DNS lookup and still succeeds while
+ *              the DNS server is unreachable.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "dns_cache.h"
+#include "time_sync.h"
+
+/*******************************************************************************
+ * Typedefines
+ ******************************************************************************/
+/* Resolved address of one hostname */
+typedef struct
+{
+    char hostname[DNS_CACHE_HOSTNAME_SIZE];
+    cy_socket_ip_address_t address;
+    uint64_t resolved_ms;       /* Monotonic time of the lookup */
+    bool expired;               /* Set by dns_cache_invalidate() */
+} dns_cache_entry_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static dns_cache_entry_t dns_cache[DNS_CACHE_ENTRIES];
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+static dns_cache_entry_t *dns_cache_find(const char *hostname);
+
+/*******************************************************************************
+ * Function Name: dns_cache_resolve
+ *******************************************************************************
+ * Summary:
+ *   Returns the IPv4 address of a hostname. An address resolved less than
+ *   DNS_CACHE_TTL_MS ago is returned without a lookup. Otherwise the
+ *   hostname is resolved and cached. If that lookup fails, an expired
+ *   address is returned, as the host is likely still there.
+ *
+ * Parameters:
+ *   hostname: null terminated hostname
+ *   address: the address is returned here
+ *   from_cache: set to true if the address was not resolved now
+ *
+ * Return:
+ *   cy_rslt_t: CY_RSLT_SUCCESS if an address is returned, else the error of
+ *              the lookup
+ ******************************************************************************/
+cy_rslt_t dns_cache_resolve(const char *hostname, cy_socket_ip_address_t *address, bool *from_cache)
+{
+    dns_cache_entry_t *entry = dns_cache_find(hostname);
+    const uint64_t now_ms = time_sync_get_mono_ms();
+    cy_rslt_t result;
+
+    if ((entry != NULL) && !entry->expired && ((now_ms - entry->resolved_ms) < DNS_CACHE_TTL_MS))
+    {
+        *address = entry->address;
+        *from_cache = true;
+        return CY_RSLT_SUCCESS;
+    }
+
+    result = cy_socket_gethostbyname(hostname, CY_SOCKET_IP_VER_V4, address);
+    if (result != CY_RSLT_SUCCESS)
+    {
+        if (entry != NULL)
+        {
+            printf("DNS lookup of '%s' failed with error 0x%0X, using the expired address\n",
+                   hostname, (int)result);
+            *address = entry->address;
+            *from_cache = true;
+            return CY_RSLT_SUCCESS;
+        }
+        return result;
+    }
+
+    if ((entry == NULL) && (strlen(hostname) < DNS_CACHE_HOSTNAME_SIZE))
+    {
+        /* Use a free entry or else replace the oldest one */
+        entry = &dns_cache[0];
+        for (uint32_t i = 0; (i < DNS_CACHE_ENTRIES) && (entry->hostname[0] != '\0'); i++)
+        {
+            if ((dns_cache[i].hostname[0] == '\0') || (dns_cache[i].resolved_ms < entry->resolved_ms))
+            {
+                entry = &dns_cache[i];
+            }
+        }
+        strcpy(entry->hostname, hostname);
+    }
+
+    if (entry != NULL)
+    {
+        entry->address = *address;
+        entry->resolved_ms = now_ms;
+        entry->expired = false;
+    }
+
+    *from_cache = false;
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: dns_cache_invalidate
+ *******************************************************************************
+ * Summary:
+ *   Expires the cached address of a hostname, e.g. after a failed
+ *   connection to it, so that the next dns_cache_resolve() looks it up
+ *   again.
+ *
+ * Parameters:
+ *   hostname: null terminated hostname
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void dns_cache_invalidate(const char *hostname)
+{
+    dns_cache_entry_t *entry = dns_cache_find(hostname);
+
+    if (entry != NULL)
+    {
+        entry->expired = true;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: dns_cache_find
+ *******************************************************************************
+ * Summary:
+ *   Looks up the cache entry of a hostname. Expired entries are returned
+ *   too, so their address can still be used if the DNS lookup fails.
+ *
+ * Parameters:
+ *   hostname: null terminated hostname
+ *
+ * Return:
+ *   dns_cache_entry_t *: entry of the hostname, NULL if there is none
+ ******************************************************************************/
+static dns_cache_entry_t *dns_cache_find(const char *hostname)
+{
+    for (uint32_t i = 0; i < DNS_CACHE_ENTRIES; i++)
+    {
+        if ((dns_cache[i].hostname[0] != '\0') && (strcmp(dns_cache[i].hostname, hostname) == 0))
+        {
+            return &dns_cache[i];
+        }
+    }
+
+    return NULL;
+}
+
+/* [] END OF FILE */
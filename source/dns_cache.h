@@ -0,0 +1,57 @@
+/******************************************************************************
+ * File Name:   dns_cache.h
+ *
+ * Description: This file contains the function prototypes of the DNS cache.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "cy_result.h"
+#include "cy_secure_sockets.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Number of hostnames kept in the cache */
+#define DNS_CACHE_ENTRIES       (4u)
+
+/* Longest cached hostname including the terminating null */
+#define DNS_CACHE_HOSTNAME_SIZE (128u)
+
+/* Time in milliseconds a resolved address is used without a new lookup. The
+ * secure sockets API does not return the TTL of the DNS record, so this
+ * should not be longer than the TTL configured for the broker hostname.
+ */
+#ifndef DNS_CACHE_TTL_MS
+#define DNS_CACHE_TTL_MS        (60u * 60u * 1000u)
+#endif
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+cy_rslt_t dns_cache_resolve(const char *hostname, cy_socket_ip_address_t *address, bool *from_cache);
+void dns_cache_invalidate(const char *hostname);
+
+/* [] END OF FILE */
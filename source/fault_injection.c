@@ -0,0 +1,449 @@
+/******************************************************************************
+ * File Name:   fault_injection.c
+ *
+ * Description: This file contains a deterministic network fault injection
+ *              used to measure the reconnection behavior. A scenario of
+ *              Wi-Fi drops, MQTT drops, broker outages and publish faults
+ *              is run step by step, and the time to reconnect and the
+ *              samples lost are reported for every step.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#include <stdio.h>
+
+/* FreeRTOS header files */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "fault_injection.h"
+
+#if (FAULT_INJECTION_ENABLED != 0)
+
+/* Middleware libraries */
+#include "cy_wcm.h"
+
+#include "app_alloc.h"
+#include "mqtt_event_ring.h"
+#include "mqtt_task.h"
+#include "prng.h"
+#include "publisher_task.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define SCENARIO_STEP_COUNT     (sizeof(scenario) / sizeof(scenario[0]))
+
+/*******************************************************************************
+ * Local Variables
+ ******************************************************************************/
+static TaskHandle_t fault_injection_task_handle = NULL;
+APP_TASK_MEMORY(fault_injection_task, FAULT_INJECTION_TASK_STACK_SIZE);
+
+/* Scenario from fault_injection_config.h */
+static const fault_injection_step_t scenario[] = { FAULT_INJECTION_SCENARIO };
+
+/* Fault of the running step. The hooks are called from other tasks, so the
+ * state is only written by the fault injection task.
+ */
+static volatile bool fault_active = false;
+static volatile fault_type_t active_fault;
+static volatile TickType_t fault_end_tick;
+static volatile bool awaiting_reconnect = false;
+
+/* Set by the connect race step, cleared by the connection it drops */
+static volatile bool drop_next_connection = false;
+
+/* Samples lost since the start of the running step */
+static volatile uint32_t samples_lost = 0;
+
+/* Random sequence of the publish loss, only used by the publisher task */
+static prng_t loss_prng;
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+static void fault_injection_task(void *pvParameters);
+static void fault_injection_run_step(uint32_t index, const fault_injection_step_t *step);
+static bool fault_is_active(fault_type_t fault);
+static const char *fault_name(fault_type_t fault);
+
+/*******************************************************************************
+ * Function Name: fault_injection_start
+ *******************************************************************************
+ * Summary:
+ *   Creates the task that runs the fault injection scenario. Called once
+ *   after the first MQTT connection.
+ *
+ * Parameters:
+ *   void
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void fault_injection_start(void)
+{
+    if (pdPASS != APP_TASK_CREATE(fault_injection_task, FAULT_INJECTION_TASK_NAME, FAULT_INJECTION_TASK_STACK_SIZE,
+                                  NULL, FAULT_INJECTION_TASK_PRIORITY, &fault_injection_task_handle))
+    {
+        printf("Failed to create '%s' task!\n", FAULT_INJECTION_TASK_NAME);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: fault_injection_connected
+ *******************************************************************************
+ * Summary:
+ *   Called by the MQTT client task after every successful reconnection. Ends
+ *   a running Wi-Fi or MQTT drop step.
+ *
+ * Parameters:
+ *   void
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void fault_injection_connected(void)
+{
+    if (awaiting_reconnect && (fault_injection_task_handle != NULL))
+    {
+        xTaskNotifyGive(fault_injection_task_handle);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: fault_injection_connect_blocked
+ *******************************************************************************
+ * Summary:
+ *   Tells the MQTT client task to fail the connection attempt, as if the
+ *   broker was not reachable.
+ *
+ * Parameters:
+ *   void
+ *
+ * Return:
+ *   bool: true while a broker outage is injected
+ ******************************************************************************/
+bool fault_injection_connect_blocked(void)
+{
+    return fault_is_active(FAULT_BROKER_DOWN);
+}
+
+/*******************************************************************************
+ * Function Name: fault_injection_drop_connected
+ *******************************************************************************
+ * Summary:
+ *   Tells the MQTT client task to drop the connection it just established,
+ *   as if the broker closed it before the client task entered the connected
+ *   state. Returns true once per connect race step.
+ *
+ * Parameters:
+ *   void
+ *
+ * Return:
+ *   bool: true if the new connection is to be dropped
+ ******************************************************************************/
+bool fault_injection_drop_connected(void)
+{
+    if (!drop_next_connection)
+    {
+        return false;
+    }
+
+    drop_next_connection = false;
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: fault_injection_drop_publish
+ *******************************************************************************
+ * Summary:
+ *   Tells the publisher task to drop the current publish. Only called from
+ *   the publisher task.
+ *
+ * Parameters:
+ *   void
+ *
+ * Return:
+ *   bool: true if the publish is to be dropped
+ ******************************************************************************/
+bool fault_injection_drop_publish(void)
+{
+    return fault_is_active(FAULT_PUBLISH_LOSS) &&
+           (prng_range(&loss_prng, 1u, 100u) <= FAULT_INJECTION_PUBLISH_LOSS_PERCENT);
+}
+
+/*******************************************************************************
+ * Function Name: fault_injection_publish_delay_ms
+ *******************************************************************************
+ * Summary:
+ *   Returns the delay the publisher task adds before the current publish.
+ *
+ * Parameters:
+ *   void
+ *
+ * Return:
+ *   uint32_t: delay in milliseconds
+ ******************************************************************************/
+uint32_t fault_injection_publish_delay_ms(void)
+{
+    return fault_is_active(FAULT_PUBLISH_LATENCY) ? FAULT_INJECTION_PUBLISH_LATENCY_MS : 0u;
+}
+
+/*******************************************************************************
+ * Function Name: fault_injection_sample_lost
+ *******************************************************************************
+ * Summary:
+ *   Counts a CO2 sample that was not delivered to the broker. Only the
+ *   telemetry and alert messages, which carry a sequence number, are
+ *   samples; diagnostics and configuration replies are not counted.
+ *
+ * Parameters:
+ *   void
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void fault_injection_sample_lost(void)
+{
+    taskENTER_CRITICAL();
+    samples_lost++;
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+ * Function Name: fault_injection_task
+ *******************************************************************************
+ * Summary:
+ *   Runs the steps of the scenario once, with a pause in between, and then
+ *   deletes itself.
+ *
+ * Parameters:
+ *   pvParameters: task parameter (unused)
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void fault_injection_task(void *pvParameters)
+{
+    (void)pvParameters;
+
+    /* Same seed on every run, so a scenario drops the same publishes */
+    prng_init(&loss_prng, prng_device_seed());
+
+    vTaskDelay(pdMS_TO_TICKS(FAULT_INJECTION_START_DELAY_MS));
+
+    for (uint32_t index = 0; index < SCENARIO_STEP_COUNT; index++)
+    {
+        fault_injection_run_step(index, &scenario[index]);
+        vTaskDelay(pdMS_TO_TICKS(FAULT_INJECTION_STEP_INTERVAL_MS));
+    }
+
+    printf("Fault injection: scenario complete\n");
+    fault_injection_task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+/*******************************************************************************
+ * Function Name: fault_injection_run_step
+ *******************************************************************************
+ * Summary:
+ *   Injects one fault and waits until the device reconnected or the fault
+ *   duration elapsed. The time to reconnect and the samples lost are
+ *   printed and published once the connection is back. The connect race
+ *   step drops the reconnection once more, so it waits for two.
+ *
+ * Parameters:
+ *   index: index of the step in the scenario
+ *   step: fault and duration of the step
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void fault_injection_run_step(uint32_t index, const fault_injection_step_t *step)
+{
+    const TickType_t start_tick = xTaskGetTickCount();
+    publisher_data_t publisher_q_data;
+    uint32_t reconnect_ms = 0;
+    uint32_t reconnects_expected = 1u;
+    uint32_t reconnects = 0;
+    bool disconnecting = false;
+    bool reconnected = true;
+
+    printf("\nFault injection: step %u '%s'\n", (unsigned int)index, fault_name(step->fault));
+
+    taskENTER_CRITICAL();
+    samples_lost = 0;
+    taskEXIT_CRITICAL();
+
+    /* Discard a notification left over from a reconnect outside a step */
+    (void)ulTaskNotifyTake(pdTRUE, 0);
+
+    active_fault = step->fault;
+    fault_end_tick = start_tick + pdMS_TO_TICKS(step->duration_ms);
+    fault_active = true;
+
+    switch (step->fault)
+    {
+        case FAULT_WIFI_DROP:
+        {
+            /* The MQTT library detects the loss on its next transfer */
+            disconnecting = true;
+            awaiting_reconnect = true;
+            cy_wcm_disconnect_ap();
+            break;
+        }
+
+        case FAULT_CONNECT_RACE:
+        {
+            /* The disconnection reported right after the reconnect must not
+             * be lost, or the device never reconnects a second time.
+             */
+            reconnects_expected = 2u;
+            drop_next_connection = true;
+            disconnecting = true;
+            awaiting_reconnect = true;
+            (void)mqtt_event_post(HANDLE_DISCONNECTION);
+            break;
+        }
+
+        case FAULT_MQTT_DROP:
+        case FAULT_BROKER_DOWN:
+        {
+            /* Same command the MQTT event callback sends on a lost broker */
+            disconnecting = true;
+            awaiting_reconnect = true;
+            (void)mqtt_event_post(HANDLE_DISCONNECTION);
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    if (disconnecting)
+    {
+        const TickType_t timeout_tick = start_tick + pdMS_TO_TICKS(FAULT_INJECTION_RECONNECT_TIMEOUT_MS);
+
+        while (reconnects < reconnects_expected)
+        {
+            const TickType_t now_tick = xTaskGetTickCount();
+            if ((int32_t)(timeout_tick - now_tick) <= 0)
+            {
+                break;
+            }
+            reconnects += ulTaskNotifyTake(pdTRUE, timeout_tick - now_tick);
+        }
+        reconnected = (reconnects >= reconnects_expected);
+        reconnect_ms = (uint32_t)(xTaskGetTickCount() - start_tick) * portTICK_PERIOD_MS;
+        awaiting_reconnect = false;
+        drop_next_connection = false;
+    }
+    else
+    {
+        vTaskDelay(pdMS_TO_TICKS(step->duration_ms));
+    }
+
+    fault_active = false;
+
+    if (!reconnected)
+    {
+        printf("Fault injection: '%s' did not reconnect within %u ms, %u samples lost\n",
+               fault_name(step->fault), (unsigned int)FAULT_INJECTION_RECONNECT_TIMEOUT_MS,
+               (unsigned int)samples_lost);
+        return;
+    }
+
+    publisher_q_data.cmd = PUBLISH_MQTT_DIAG;
+    publisher_q_data.seq = 0;
+    if (disconnecting)
+    {
+        printf("Fault injection: '%s' reconnected after %u ms, %u samples lost\n",
+               fault_name(step->fault), (unsigned int)reconnect_ms, (unsigned int)samples_lost);
+        snprintf(publisher_q_data.data, sizeof(publisher_q_data.data),
+                 "{\"fault\": \"%s\", \"ttr_ms\": %lu, \"lost\": %lu}",
+                 fault_name(step->fault), (unsigned long)reconnect_ms, (unsigned long)samples_lost);
+    }
+    else
+    {
+        printf("Fault injection: '%s' finished, %u samples lost\n",
+               fault_name(step->fault), (unsigned int)samples_lost);
+        snprintf(publisher_q_data.data, sizeof(publisher_q_data.data),
+                 "{\"fault\": \"%s\", \"lost\": %lu}",
+                 fault_name(step->fault), (unsigned long)samples_lost);
+    }
+    (void)publisher_post(&publisher_q_data);
+}
+
+/*******************************************************************************
+ * Function Name: fault_is_active
+ *******************************************************************************
+ * Summary:
+ *   Checks if the given fault is injected and its duration did not elapse.
+ *
+ * Parameters:
+ *   fault: fault to check
+ *
+ * Return:
+ *   bool: true if the fault is active
+ ******************************************************************************/
+static bool fault_is_active(fault_type_t fault)
+{
+    return fault_active && (active_fault == fault) &&
+           ((int32_t)(xTaskGetTickCount() - fault_end_tick) < 0);
+}
+
+/*******************************************************************************
+ * Function Name: fault_name
+ *******************************************************************************
+ * Summary:
+ *   Returns the short name of a fault used in the reports.
+ *
+ * Parameters:
+ *   fault: fault type
+ *
+ * Return:
+ *   const char *: name of the fault
+ ******************************************************************************/
+static const char *fault_name(fault_type_t fault)
+{
+    switch (fault)
+    {
+        case FAULT_WIFI_DROP:
+            return "wifi_drop";
+        case FAULT_MQTT_DROP:
+            return "mqtt_drop";
+        case FAULT_BROKER_DOWN:
+            return "broker_down";
+        case FAULT_CONNECT_RACE:
+            return "connect_race";
+        case FAULT_PUBLISH_LOSS:
+            return "pub_loss";
+        case FAULT_PUBLISH_LATENCY:
+            return "pub_delay";
+        default:
+            return "unknown";
+    }
+}
+
+#endif /* FAULT_INJECTION_ENABLED */
+
+/* [] END OF FILE */
@@ -0,0 +1,84 @@
+/******************************************************************************
+ * File Name:   fault_injection.h
+ *
+ * Description: This file is the public interface of fault_injection.c
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "fault_injection_config.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define FAULT_INJECTION_TASK_NAME       "FAULT INJECTION TASK"
+#define FAULT_INJECTION_TASK_PRIORITY   (1)
+#define FAULT_INJECTION_TASK_STACK_SIZE (1024 * 1)
+
+/*******************************************************************************
+ * Typedefines
+ ******************************************************************************/
+/* Faults that can be injected by the scenario */
+typedef enum
+{
+    FAULT_WIFI_DROP,            /* Disconnect from the Wi-Fi AP */
+    FAULT_MQTT_DROP,            /* Drop the MQTT connection, as on a broker restart */
+    FAULT_BROKER_DOWN,          /* Drop the MQTT connection and fail reconnects */
+    FAULT_CONNECT_RACE,         /* Drop the MQTT connection, and again right after the reconnect */
+    FAULT_PUBLISH_LOSS,         /* Drop a share of the publishes */
+    FAULT_PUBLISH_LATENCY       /* Delay every publish */
+} fault_type_t;
+
+/* One step of the fault injection scenario */
+typedef struct
+{
+    fault_type_t fault;
+    uint32_t duration_ms;
+} fault_injection_step_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+#if (FAULT_INJECTION_ENABLED != 0)
+void fault_injection_start(void);
+void fault_injection_connected(void);
+bool fault_injection_connect_blocked(void);
+bool fault_injection_drop_connected(void);
+bool fault_injection_drop_publish(void);
+uint32_t fault_injection_publish_delay_ms(void);
+void fault_injection_sample_lost(void);
+#else
+/* The hooks compile to nothing when the fault injection is disabled */
+#define fault_injection_start()             do { } while (0)
+#define fault_injection_connected()         do { } while (0)
+#define fault_injection_connect_blocked()   (false)
+#define fault_injection_drop_connected()    (false)
+#define fault_injection_drop_publish()      (false)
+#define fault_injection_publish_delay_ms()  (0u)
+#define fault_injection_sample_lost()       do { } while (0)
+#endif /* FAULT_INJECTION_ENABLED */
+
+/* [] END OF FILE */
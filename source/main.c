@@ -26,6 +26,7 @@
 
 /* Header file includes */
 #include "FreeRTOS.h"
+#include "app_alloc.h"
 #include "cy_retarget_io.h"
 #include "cybsp.h"
 #include "cyhal.h"
@@ -53,6 +54,8 @@ static void isr_timer(void *callback_arg, cyhal_timer_event_t event);
 volatile int uxTopUsedPriority;
 /* Timer object used for blinking the LED */
 cyhal_timer_t led_blink_timer;
+/* Stack and control block of the MQTT client task in the static build */
+APP_TASK_MEMORY(mqtt_client_task, MQTT_CLIENT_TASK_STACK_SIZE);
 /******************************************************************************
  * Function Name: main
  ******************************************************************************
@@ -103,8 +106,8 @@ int main(void)
     printf("=====================================================================\n\n");
 
     /* Create the MQTT Client task. */
-    xTaskCreate(mqtt_client_task, "MQTT Client task", MQTT_CLIENT_TASK_STACK_SIZE,
-                NULL, MQTT_CLIENT_TASK_PRIORITY, NULL);
+    APP_TASK_CREATE(mqtt_client_task, "MQTT Client task", MQTT_CLIENT_TASK_STACK_SIZE,
+                    NULL, MQTT_CLIENT_TASK_PRIORITY, &mqtt_client_task_handle);
 
     /* Start the FreeRTOS scheduler. */
     vTaskStartScheduler();
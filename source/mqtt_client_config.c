@@ -32,7 +32,21 @@
 /******************************************************************************
 * Global Variables
 *******************************************************************************/
-/* MQTT Broker/Server details */
+/* MQTT Brokers/Servers in the order of the configuration */
+const mqtt_broker_endpoint_t broker_endpoints[] =
+{
+#ifdef MQTT_SNI_HOSTNAME
+    { MQTT_BROKER_ADDRESS, MQTT_PORT, 0, MQTT_SNI_HOSTNAME },
+#else
+    { MQTT_BROKER_ADDRESS, MQTT_PORT, 0, NULL },
+#endif /* MQTT_SNI_HOSTNAME */
+    MQTT_BROKER_FALLBACKS
+};
+const uint32_t broker_endpoint_count = sizeof(broker_endpoints) / sizeof(broker_endpoints[0]);
+
+/* MQTT Broker/Server details of the MQTT client instance. The address of
+ * the selected broker is filled in before each connection.
+ */
 cy_mqtt_broker_info_t broker_info =
 {
     .hostname = MQTT_BROKER_ADDRESS,
@@ -86,13 +100,13 @@ static cy_awsport_ssl_credentials_t credentials =
      * Client Hello message sent during TLS handshake as specified by the
      * MQTT Broker.
      */
-#ifdef MQTT_SNI_HOSTNAME
-    .sni_host_name = (const char *)MQTT_SNI_HOSTNAME,
-    .sni_host_name_size = sizeof(MQTT_SNI_HOSTNAME)
-#else
-    .sni_host_name = NULL,
-    .sni_host_name_size = 0
-#endif
+    /* The broker is connected by its cached IP address, so the SNI hostname
+     * of the selected broker is set before each connection, to select and
+     * verify the broker certificate. MQTT_SNI_HOSTNAME only applies to
+     * MQTT_BROKER_ADDRESS, see broker_endpoints[].
+     */
+    .sni_host_name = (const char *)MQTT_BROKER_ADDRESS,
+    .sni_host_name_size = sizeof(MQTT_BROKER_ADDRESS)
 };
 
 /* Pointer to the security details of the MQTT connection. */
@@ -141,6 +155,9 @@ cy_mqtt_connect_info_t connection_info =
 #if ((MQTT_MESSAGES_QOS != 0) && (MQTT_MESSAGES_QOS != 1) && (MQTT_MESSAGES_QOS != 2))
     #error "Invalid QoS setting! MQTT_MESSAGES_QOS must be either 0 or 1."
 #endif
+#if ((MQTT_TELEMETRY_QOS != 0) && (MQTT_TELEMETRY_QOS != 1) && (MQTT_TELEMETRY_QOS != 2))
+    #error "Invalid QoS setting! MQTT_TELEMETRY_QOS must be either 0 or 1."
+#endif
 
 
 /* [] END OF FILE */
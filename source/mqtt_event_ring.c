@@ -0,0 +1,263 @@
+/******************************************************************************
+ * File Name:   mqtt_event_ring.c
+ *
+ * Description: This file contains the ring of the events sent to the MQTT
+ *              client task. The events are posted without blocking, so that the
+ *              callback of the MQTT library never waits for the MQTT client task.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "task.h"
+
+#include "app_alloc.h"
+#include "mqtt_event_ring.h"
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+/* Ring of the events, oldest at 'event_head'. A disconnection only sets
+ * 'event_disconnect_pending', further disconnections are merged into it.
+ */
+static mqtt_task_cmd_t event_ring[MQTT_EVENT_RING_LENGTH];
+static uint32_t event_head = 0;
+static uint32_t event_depth = 0;
+static bool event_disconnect_pending = false;
+static mqtt_event_stats_t event_stats;
+
+/* Wakes up the MQTT client task when an event is posted */
+static SemaphoreHandle_t event_wakeup = NULL;
+APP_BINARY_MEMORY(event_wakeup);
+
+/*******************************************************************************
+ * Function Name: mqtt_event_ring_init
+ *******************************************************************************
+ * Summary:
+ *   Creates the semaphore that wakes up the MQTT client task. Events posted
+ *   before are kept and handled on the first wait.
+ *
+ * Parameters:
+ *   void
+ *
+ * Return:
+ *   cy_rslt_t: CY_RSLT_SUCCESS, or an error if the semaphore could
+ *              not be created
+ ******************************************************************************/
+cy_rslt_t mqtt_event_ring_init(void)
+{
+    if (event_wakeup == NULL)
+    {
+        event_wakeup = APP_BINARY_CREATE(event_wakeup);
+    }
+
+    return (event_wakeup != NULL) ? CY_RSLT_SUCCESS : ~CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_event_post
+ *******************************************************************************
+ * Summary:
+ *   Posts an event to the MQTT client task without blocking. Can be called
+ *   from the MQTT library callback and from any task, but not from an ISR.
+ *
+ * Parameters:
+ *   cmd: event to post
+ *
+ * Return:
+ *   bool: false if the event was dropped because the ring was full
+ ******************************************************************************/
+bool mqtt_event_post(mqtt_task_cmd_t cmd)
+{
+    bool posted = true;
+
+    taskENTER_CRITICAL();
+    if (cmd == HANDLE_DISCONNECTION)
+    {
+        if (event_disconnect_pending)
+        {
+            event_stats.coalesced++;
+        }
+        else
+        {
+            event_disconnect_pending = true;
+            event_stats.posted++;
+        }
+    }
+    else if (event_depth == MQTT_EVENT_RING_LENGTH)
+    {
+        event_stats.overflow++;
+        posted = false;
+    }
+    else
+    {
+        event_ring[(event_head + event_depth) % MQTT_EVENT_RING_LENGTH] = cmd;
+        event_depth++;
+        event_stats.posted++;
+        if (event_depth > event_stats.max_depth)
+        {
+            event_stats.max_depth = event_depth;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if (posted && (event_wakeup != NULL))
+    {
+        /* A wakeup already pending is enough, the give does not block. */
+        (void)xSemaphoreGive(event_wakeup);
+    }
+
+    return posted;
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_event_take
+ *******************************************************************************
+ * Summary:
+ *   Removes the next event. A pending disconnection is returned first, the
+ *   other events are handled after the reconnection or discarded by it.
+ *
+ * Parameters:
+ *   cmd: location to store the event
+ *
+ * Return:
+ *   bool: true if an event was removed
+ ******************************************************************************/
+static bool mqtt_event_take(mqtt_task_cmd_t *cmd)
+{
+    bool taken = true;
+
+    taskENTER_CRITICAL();
+    if (event_disconnect_pending)
+    {
+        event_disconnect_pending = false;
+        *cmd = HANDLE_DISCONNECTION;
+    }
+    else if (event_depth > 0u)
+    {
+        *cmd = event_ring[event_head];
+        event_head = (event_head + 1u) % MQTT_EVENT_RING_LENGTH;
+        event_depth--;
+    }
+    else
+    {
+        taken = false;
+    }
+    taskEXIT_CRITICAL();
+
+    return taken;
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_event_wait
+ *******************************************************************************
+ * Summary:
+ *   Waits for the next event. Only called by the MQTT client task.
+ *
+ * Parameters:
+ *   cmd: location to store the event
+ *   ticks: maximum time to wait
+ *
+ * Return:
+ *   bool: true if an event was received, false on timeout
+ ******************************************************************************/
+bool mqtt_event_wait(mqtt_task_cmd_t *cmd, TickType_t ticks)
+{
+    if (mqtt_event_take(cmd))
+    {
+        return true;
+    }
+
+    if (pdTRUE != xSemaphoreTake(event_wakeup, ticks))
+    {
+        return false;
+    }
+
+    /* A wakeup left from events taken earlier returns no event, the caller
+     * handles it as a timeout.
+     */
+    return mqtt_event_take(cmd);
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_event_reset
+ *******************************************************************************
+ * Summary:
+ *   Discards the events of a previous connection. The counters are kept.
+ *
+ * Parameters:
+ *   void
+ *
+ * Return:
+ *   void
+ ******************************************************************************/
+void mqtt_event_reset(void)
+{
+    taskENTER_CRITICAL();
+    event_head = 0;
+    event_depth = 0;
+    event_disconnect_pending = false;
+    taskEXIT_CRITICAL();
+
+    (void)xSemaphoreTake(event_wakeup, 0);
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_event_message_dropped
+ *******************************************************************************
+ * Summary:
+ *   Counts an incoming message that the MQTT library callback dropped
+ *   instead of waiting for its buffer.
+ *
+ * Parameters:
+ *   void
+ *
+ * Return:
+ *   void
+ ******************************************************************************/
+void mqtt_event_message_dropped(void)
+{
+    taskENTER_CRITICAL();
+    event_stats.msg_dropped++;
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_event_get_stats
+ *******************************************************************************
+ * Summary:
+ *   Returns a copy of the counters of the event ring.
+ *
+ * Parameters:
+ *   stats: location to store the counters
+ *
+ * Return:
+ *   void
+ ******************************************************************************/
+void mqtt_event_get_stats(mqtt_event_stats_t *stats)
+{
+    taskENTER_CRITICAL();
+    *stats = event_stats;
+    taskEXIT_CRITICAL();
+}
+
+/* [] END OF FILE */
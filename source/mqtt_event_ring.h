@@ -0,0 +1,72 @@
+/******************************************************************************
+ * File Name:   mqtt_event_ring.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *              in mqtt_event_ring.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "cy_result.h"
+
+#include "mqtt_task.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Number of events the ring holds for the MQTT client task. A disconnection
+ * is kept outside of the ring and is never lost. When the ring is full, the
+ * new event is dropped and counted.
+ */
+#ifndef MQTT_EVENT_RING_LENGTH
+#define MQTT_EVENT_RING_LENGTH      (8u)
+#endif
+
+/*******************************************************************************
+ * Typedefines
+ ******************************************************************************/
+/* Counters of the event ring */
+typedef struct
+{
+    uint32_t posted;            /* Events accepted by the ring */
+    uint32_t coalesced;         /* Disconnections merged into a pending one */
+    uint32_t overflow;          /* Events dropped because the ring was full */
+    uint32_t max_depth;         /* Largest number of events waiting */
+    uint32_t msg_dropped;       /* Incoming messages dropped by the callback */
+} mqtt_event_stats_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+cy_rslt_t mqtt_event_ring_init(void);
+bool mqtt_event_post(mqtt_task_cmd_t cmd);
+bool mqtt_event_wait(mqtt_task_cmd_t *cmd, TickType_t ticks);
+void mqtt_event_reset(void);
+void mqtt_event_message_dropped(void);
+void mqtt_event_get_stats(mqtt_event_stats_t *stats);
+
+/* [] END OF FILE */
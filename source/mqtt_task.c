@@ -36,14 +36,28 @@
 #include "task.h"
 
 /* Task header files */
+#include "app_alloc.h"
+#include "app_event_loop.h"
+#include "backoff.h"
+#include "broker_select.h"
+#include "conn_timing.h"
+#include "dns_cache.h"
+#include "fault_injection.h"
+#include "mqtt_event_ring.h"
 #include "mqtt_task.h"
+#include "mqtt_topic.h"
 #include "pasco2_task.h"
+#include "prng.h"
 #include "publisher_task.h"
+#include "stack_calibration.h"
 #include "subscriber_task.h"
+#include "time_sync.h"
+#include "wifi_rejoin.h"
 
 /* Configuration file for Wi-Fi and MQTT client */
 #include "wifi_config.h"
 #include "mqtt_client_config.h"
+#include "time_sync_config.h"
 
 /* Middleware libraries */
 #include "cy_retarget_io.h"
@@ -51,6 +65,7 @@
 #include "cy_lwip.h"
 
 #include "cy_mqtt_api.h"
+#include "cy_secure_sockets.h"
 #include "clock.h"
 
 /* LwIP header files */
@@ -59,40 +74,36 @@
 /*******************************************************************************
  * Macros
  ******************************************************************************/
-/* Queue length of a message queue that is used to communicate the status of
- * various operations.
+/* Bits of 'mqtt_status_events' tracking which cleanup functions must be
+ * called. MQTT_STATUS_CONNECTED, bit 5, is defined in mqtt_task.h.
  */
-#define MQTT_TASK_QUEUE_LENGTH           (3u)
-
-/* Time in milliseconds to wait before creating the publisher task. */
-#define TASK_CREATION_DELAY_MS           (2000u)
-
-/* Flag Masks for tracking which cleanup functions must be called. */
 #define WCM_INITIALIZED                  (1lu << 0)
 #define WIFI_CONNECTED                   (1lu << 1)
 #define LIBS_INITIALIZED                 (1lu << 2)
 #define BUFFER_INITIALIZED               (1lu << 3)
 #define MQTT_INSTANCE_CREATED            (1lu << 4)
-#define MQTT_CONNECTION_SUCCESS          (1lu << 5)
 #define MQTT_MSG_RECEIVED                (1lu << 6)
 
+/* Size of an IPv4 address in dotted decimal notation */
+#define BROKER_IP_STR_SIZE               (16u)
+
 /* Macro to check if the result of an operation was successful and set the
- * corresponding bit in the status_flag based on 'init_mask' parameter. When
- * it has failed, print the error message and return the result to the
+ * corresponding bit in 'mqtt_status_events' based on 'init_mask' parameter.
+ * When it has failed, print the error message and return the result to the
  * calling function.
  */
-#define CHECK_RESULT(result, init_mask, error_message...)      \
-                     do                                        \
-                     {                                         \
-                         if ((int)result == CY_RSLT_SUCCESS)   \
-                         {                                     \
-                             status_flag |= init_mask;         \
-                         }                                     \
-                         else                                  \
-                         {                                     \
-                             printf(error_message);            \
-                             return result;                    \
-                         }                                     \
+#define CHECK_RESULT(result, init_mask, error_message...)                        \
+                     do                                                          \
+                     {                                                           \
+                         if ((int)result == CY_RSLT_SUCCESS)                     \
+                         {                                                       \
+                             xEventGroupSetBits(mqtt_status_events, init_mask);  \
+                         }                                                       \
+                         else                                                    \
+                         {                                                       \
+                             printf(error_message);                              \
+                             return result;                                      \
+                         }                                                       \
                      } while(0)
 
 /*******************************************************************************
@@ -101,26 +112,79 @@
 /* MQTT connection handle. */
 cy_mqtt_t mqtt_connection;
 
-/* Queue handle used to communicate results of various operations - MQTT
- * Publish, MQTT Subscribe, MQTT connection, and Wi-Fi connection between tasks
- * and callbacks.
- */
-QueueHandle_t mqtt_task_q;
+/* FreeRTOS task handle of the MQTT client task. */
+TaskHandle_t mqtt_client_task_handle;
 
-/* Flag to denote initialization status of various operations. */
-uint32_t status_flag;
+/* Initialization status of various operations and the connection status.
+ * The bits are set and cleared atomically by the MQTT client task and the
+ * MQTT callback, and other tasks can wait for them.
+ */
+EventGroupHandle_t mqtt_status_events;
+APP_EVENT_GROUP_MEMORY(mqtt_status_events);
 
 /* Pointer to the network buffer needed by the MQTT library for MQTT send and
  * receive operations.
  */
 uint8_t *mqtt_network_buffer = NULL;
 
+#if (APP_STATIC_ALLOCATION != 0)
+/* Network buffer of the static build */
+static uint8_t mqtt_network_buffer_storage[MQTT_NETWORK_BUFFER_SIZE];
+#endif
+
+/* Memory of the application tasks in the static build */
+#if (APP_EVENT_LOOP_ENABLED != 0)
+APP_TASK_MEMORY(app_event_loop_task, APP_EVENT_LOOP_TASK_STACK_SIZE);
+#else
+APP_TASK_MEMORY(subscriber_task, SUBSCRIBER_TASK_STACK_SIZE);
+APP_TASK_MEMORY(publisher_task, PUBLISHER_TASK_STACK_SIZE);
+#endif
+APP_TASK_MEMORY(pasco2_task, PASCO2_TASK_STACK_SIZE);
+
+/* Current state of the connection state machine and timing of all states. */
+conn_state_t conn_state = CONN_STATE_WIFI_CONNECTING;
+conn_state_metrics_t conn_state_metrics[CONN_STATE_COUNT];
+
+/******************************************************************************
+* Local Variables
+*******************************************************************************/
+/* Names of the connection states used in the log messages. */
+static const char *const conn_state_names[CONN_STATE_COUNT] =
+{
+    "WIFI_CONNECTING",
+    "MQTT_CONNECTING",
+    "CONNECTED"
+};
+
+/* Monotonic time the current state was entered and the connection attempts
+ * made since.
+ */
+static uint64_t conn_state_entered_ms;
+static uint32_t conn_state_attempts;
+
+/* Broker and address the MQTT instance connects to. The broker is connected
+ * by the address from the DNS cache, while its hostname is still sent in the
+ * SNI and verified against the certificate.
+ */
+static const mqtt_broker_endpoint_t *broker_endpoint = NULL;
+static char broker_ip_str[BROKER_IP_STR_SIZE];
+
+/* Retry delays of the Wi-Fi and MQTT connections. */
+static backoff_t wifi_backoff;
+static backoff_t mqtt_backoff;
+
 /******************************************************************************
 * Function Prototypes
 *******************************************************************************/
 static cy_rslt_t wifi_connect(void);
 static cy_rslt_t mqtt_init(void);
 static cy_rslt_t mqtt_connect(void);
+static cy_rslt_t mqtt_set_broker_address(const mqtt_broker_endpoint_t *endpoint,
+                                         const cy_socket_ip_address_t *address);
+static cy_rslt_t create_app_tasks(void);
+static void conn_state_enter(conn_state_t new_state);
+static void conn_retry_delay(backoff_t *backoff, const char *name);
+static void print_event_stats(void);
 void mqtt_event_callback(cy_mqtt_t mqtt_handle, cy_mqtt_event_t event, void *user_data);
 static void cleanup(void);
 
@@ -134,8 +198,9 @@ static cy_rslt_t mqtt_get_unique_client_identifier(char *mqtt_client_identifier)
  * Summary:
  *  Task for handling initialization & connection of Wi-Fi and the MQTT client.
  *  The task also creates and manages the subscriber and publisher tasks upon
- *  successful MQTT connection. The task also handles the WiFi and MQTT
- *  connections by initiating reconnection on the event of disconnections.
+ *  successful MQTT connection. The connections are driven by a state machine
+ *  that retries each connection with a jittered exponential backoff until it
+ *  succeeds, and reconnects on the event of disconnections.
  *
  * Parameters:
  *  void *pvParameters : Task parameter defined during task creation (unused)
@@ -153,130 +218,148 @@ void mqtt_client_task(void *pvParameters)
     subscriber_data_t subscriber_q_data;
     publisher_data_t publisher_q_data;
 
+    /* Monotonic time of the next wall-clock time synchronization */
+    uint64_t next_time_sync_ms = 0;
+
+    /* The application tasks are created on the first MQTT connection */
+    bool app_tasks_created = false;
+
     /* Configure the Wi-Fi interface as a Wi-Fi STA (i.e. Client). */
     cy_wcm_config_t config = {.interface = CY_WCM_INTERFACE_TYPE_STA};
 
     /* To avoid compiler warnings */
     (void) pvParameters;
 
-    /* Create a message queue to communicate with other tasks and callbacks. */
-    mqtt_task_q = xQueueCreate(MQTT_TASK_QUEUE_LENGTH, sizeof(mqtt_task_cmd_t));
-
-    /* Initialize the Wi-Fi Connection Manager and jump to the cleanup block
-     * upon failure.
+    /* The cleanup reads the status bits, so the event group is created
+     * first.
      */
-    if (CY_RSLT_SUCCESS != cy_wcm_init(&config))
+    mqtt_status_events = APP_EVENT_GROUP_CREATE(mqtt_status_events);
+    if (mqtt_status_events == NULL)
     {
-        printf("\nWi-Fi Connection Manager initialization failed!\n");
-        goto exit_cleanup;
+        printf("\nMQTT status event group creation failed!\n");
+        vTaskDelete(NULL);
     }
 
-    /* Set the appropriate bit in the status_flag to denote successful
-     * WCM initialization.
+    /* The other tasks and the MQTT callback post their events to the event
+     * ring, which wakes up this task.
      */
-    status_flag |= WCM_INITIALIZED;
-    printf("\nWi-Fi Connection Manager initialized.\n");
-
-    /* Initiate connection to the Wi-Fi AP and cleanup if the operation fails. */
-    if (CY_RSLT_SUCCESS != wifi_connect())
+    if (CY_RSLT_SUCCESS != mqtt_event_ring_init())
     {
+        printf("\nMQTT event ring creation failed!\n");
         goto exit_cleanup;
     }
 
-    /* Set-up the MQTT client and connect to the MQTT broker. Jump to the
-     * cleanup block if any of the operations fail.
-     */
-    if ( (CY_RSLT_SUCCESS != mqtt_init()) || (CY_RSLT_SUCCESS != mqtt_connect()) )
-    {
-        goto exit_cleanup;
-    }
+    /* Time the phases of each connection setup. */
+    conn_timing_init();
+    conn_timing_begin();
 
-    /* Create the subscriber task and cleanup if the operation fails. */
-    if (pdPASS != xTaskCreate(subscriber_task, "Subscriber task", SUBSCRIBER_TASK_STACK_SIZE,
-                              NULL, SUBSCRIBER_TASK_PRIORITY, &subscriber_task_handle))
+    /* Initialize the Wi-Fi Connection Manager and jump to the cleanup block
+     * upon failure.
+     */
+    if (CY_RSLT_SUCCESS != cy_wcm_init(&config))
     {
-        printf("Failed to create the Subscriber task!\n");
+        printf("\nWi-Fi Connection Manager initialization failed!\n");
         goto exit_cleanup;
     }
 
-    /* Wait for the subscribe operation to complete. */
-    vTaskDelay(pdMS_TO_TICKS(TASK_CREATION_DELAY_MS));
+    /* Set the appropriate bit in 'mqtt_status_events' to denote successful
+     * WCM initialization.
+     */
+    xEventGroupSetBits(mqtt_status_events, WCM_INITIALIZED);
+    printf("\nWi-Fi Connection Manager initialized.\n");
 
-    /* Create the publisher task and cleanup if the operation fails. */
-    if (pdPASS != xTaskCreate(publisher_task, "Publisher task", PUBLISHER_TASK_STACK_SIZE,
-                              NULL, PUBLISHER_TASK_PRIORITY, &publisher_task_handle))
+    /* Set-up the MQTT client and jump to the cleanup block upon failure. */
+    if (CY_RSLT_SUCCESS != mqtt_init())
     {
-        printf("Failed to create Publisher task!\n");
         goto exit_cleanup;
     }
 
-    /* Initializes context object of PASCO2 library, sets default */
-    /* parameters values for sensor and continuously acquire data from sensor. */
-    if (pdPASS != xTaskCreate(pasco2_task, PASCO2_TASK_NAME, PASCO2_TASK_STACK_SIZE,
-                              NULL, PASCO2_TASK_PRIORITY, &pasco2_task_handle))
-    {
-        printf("Failed to create '%s' task!\n", PASCO2_TASK_NAME);
-        goto exit_cleanup;
-    }
+    /* Seed the two backoffs differently, so their delays are independent. */
+    backoff_init(&wifi_backoff, WIFI_CONN_RETRY_INTERVAL_MS, WIFI_CONN_RETRY_MAX_INTERVAL_MS,
+                 prng_device_seed());
+    backoff_init(&mqtt_backoff, MQTT_CONN_RETRY_INTERVAL_MS, MQTT_CONN_RETRY_MAX_INTERVAL_MS,
+                 ~prng_device_seed());
+
+    conn_state = CONN_STATE_WIFI_CONNECTING;
+    conn_state_entered_ms = time_sync_get_mono_ms();
+    conn_state_metrics[conn_state].entries++;
 
     while (true)
     {
-        /* Wait for results of MQTT operations from other tasks and callbacks. */
-        if (pdTRUE == xQueueReceive(mqtt_task_q, &mqtt_status, portMAX_DELAY))
+        switch (conn_state)
         {
-            /* In this code example, the disconnection from the MQTT Broker or
-             * the Wi-Fi network is handled by the case 'HANDLE_DISCONNECTION'.
-             *
-             * The publish and subscribe failures (`HANDLE_MQTT_PUBLISH_FAILURE`
-             * and `HANDLE_MQTT_SUBSCRIBE_FAILURE`) does not initiate
-             * reconnection in this example, but they can be handled as per the
-             * application requirement in the following swich cases.
-             */
-            switch(mqtt_status)
+            case CONN_STATE_WIFI_CONNECTING:
             {
-                case HANDLE_MQTT_PUBLISH_FAILURE:
+                /* Connect to the Wi-Fi AP. */
+                conn_state_attempts++;
+                conn_state_metrics[conn_state].attempts++;
+                conn_timing_attempt();
+                if (CY_RSLT_SUCCESS == wifi_connect())
                 {
-                    /* Handle Publish Failure here. */
-                    break;
+                    backoff_reset(&wifi_backoff);
+                    conn_state_enter(CONN_STATE_MQTT_CONNECTING);
+                }
+                else
+                {
+                    conn_retry_delay(&wifi_backoff, "Wi-Fi");
                 }
+                break;
+            }
 
-                case HANDLE_MQTT_SUBSCRIBE_FAILURE:
+            case CONN_STATE_MQTT_CONNECTING:
+            {
+                if (cy_wcm_is_connected_to_ap() == 0)
                 {
-                    /* Handle Subscribe Failure here. */
+                    printf("Unexpectedly disconnected from Wi-Fi network! Initiating Wi-Fi reconnection...\n");
+                    xEventGroupClearBits(mqtt_status_events, WIFI_CONNECTED);
+                    conn_state_enter(CONN_STATE_WIFI_CONNECTING);
                     break;
                 }
 
-                case HANDLE_DISCONNECTION:
+                /* Connect to the MQTT broker. */
+                conn_state_attempts++;
+                conn_state_metrics[conn_state].attempts++;
+                conn_timing_attempt();
+                if (CY_RSLT_SUCCESS != mqtt_connect())
                 {
-                    /* Deinit the publisher before initiating reconnections. */
-                    publisher_q_data.cmd = PUBLISHER_DEINIT;
-                    xQueueSend(publisher_task_q, &publisher_q_data, portMAX_DELAY);
+                    conn_retry_delay(&mqtt_backoff, "MQTT");
+                    break;
+                }
 
-                    /* Although the connection with the MQTT Broker is lost,
-                     * call the MQTT disconnect API for cleanup of threads and
-                     * other resources before reconnection.
-                     */
-                    cy_mqtt_disconnect(mqtt_connection);
+                backoff_reset(&mqtt_backoff);
+                conn_state_enter(CONN_STATE_CONNECTED);
 
-                    /* Check if Wi-Fi connection is active. If not, update the
-                     * status flag and initiate Wi-Fi reconnection.
+                if (!app_tasks_created)
+                {
+                    /* Synchronize the wall-clock time used to time stamp the
+                     * samples. A failure is not fatal, the synchronization is
+                     * retried periodically.
                      */
-                    if (cy_wcm_is_connected_to_ap() == 0)
-                    {
-                        status_flag &= ~(WIFI_CONNECTED);
-                        printf("Initiating Wi-Fi Reconnection...\n");
-                        if (CY_RSLT_SUCCESS != wifi_connect())
-                        {
-                            goto exit_cleanup;
-                        }
-                    }
+                    time_sync_update();
+                    next_time_sync_ms = time_sync_get_mono_ms() + (time_sync_is_valid() ? TIME_SYNC_INTERVAL_MS
+                                                                                        : TIME_SYNC_RETRY_INTERVAL_MS);
 
-                    printf("Initiating MQTT Reconnection...\n");
-                    if (CY_RSLT_SUCCESS != mqtt_connect())
+                    /* Create the subscriber, publisher and sensor tasks and
+                     * cleanup if the operation fails.
+                     */
+                    if (CY_RSLT_SUCCESS != create_app_tasks())
                     {
                         goto exit_cleanup;
                     }
+                    app_tasks_created = true;
 
+                    /* Run the network fault scenario, only if
+                     * FAULT_INJECTION_ENABLED is set.
+                     */
+                    fault_injection_start();
+
+                    /* Drive the worst-case paths and print the stack sizes,
+                     * only if STACK_CALIBRATION_ENABLED is set.
+                     */
+                    stack_calibration_start();
+                }
+                else
+                {
                     /* Initiate MQTT subscribe post the reconnection. */
                     subscriber_q_data.cmd = SUBSCRIBE_TO_TOPIC;
                     xQueueSend(subscriber_task_q, &subscriber_q_data, portMAX_DELAY);
@@ -284,20 +367,115 @@ void mqtt_client_task(void *pvParameters)
                     /* Initialize Publisher post the reconnection. */
                     publisher_q_data.cmd = PUBLISHER_INIT;
                     xQueueSend(publisher_task_q, &publisher_q_data, portMAX_DELAY);
-                    break;
+
+                    fault_injection_connected();
+                }
+                break;
+            }
+
+            case CONN_STATE_CONNECTED:
+            {
+                /* Resynchronize the wall-clock time periodically. */
+                uint64_t now_ms = time_sync_get_mono_ms();
+                if (now_ms >= next_time_sync_ms)
+                {
+                    time_sync_update();
+                    now_ms = time_sync_get_mono_ms();
+                    next_time_sync_ms = now_ms + (time_sync_is_valid() ? TIME_SYNC_INTERVAL_MS
+                                                                       : TIME_SYNC_RETRY_INTERVAL_MS);
                 }
 
-                default:
+                /* Wait for results of MQTT operations from other tasks and
+                 * callbacks until the next resynchronization. The wait is
+                 * limited to one interval, so that the 64 bit difference
+                 * never overflows the 32 bit tick arithmetic.
+                 */
+                uint64_t wait_ms = next_time_sync_ms - now_ms;
+                if (wait_ms > TIME_SYNC_INTERVAL_MS)
+                {
+                    wait_ms = TIME_SYNC_INTERVAL_MS;
+                }
+                if (!mqtt_event_wait(&mqtt_status, (TickType_t)(wait_ms / portTICK_PERIOD_MS)))
+                {
                     break;
+                }
+
+                /* In this code example, the disconnection from the MQTT Broker
+                 * or the Wi-Fi network is handled by the case
+                 * 'HANDLE_DISCONNECTION'.
+                 *
+                 * The publish failures (`HANDLE_MQTT_PUBLISH_FAILURE`) do not
+                 * initiate reconnection in this example, but they can be
+                 * handled as per the application requirement in the following
+                 * switch cases.
+                 */
+                switch(mqtt_status)
+                {
+                    case HANDLE_MQTT_PUBLISH_FAILURE:
+                    {
+                        /* The publisher keeps the failed telemetry and
+                         * alerts and redelivers them after the reconnection.
+                         */
+                        break;
+                    }
+
+                    case HANDLE_MQTT_SUBSCRIBE_FAILURE:
+                    {
+                        /* The subscriber task backs off between its retries,
+                         * so keep requesting the subscription until it
+                         * succeeds.
+                         */
+                        subscriber_q_data.cmd = SUBSCRIBE_TO_TOPIC;
+                        xQueueSend(subscriber_task_q, &subscriber_q_data, portMAX_DELAY);
+                        break;
+                    }
+
+                    case HANDLE_DISCONNECTION:
+                    {
+                        /* Deinit the publisher before initiating reconnections. */
+                        publisher_q_data.cmd = PUBLISHER_DEINIT;
+                        xQueueSend(publisher_task_q, &publisher_q_data, portMAX_DELAY);
+
+                        /* Although the connection with the MQTT Broker is
+                         * lost, call the MQTT disconnect API for cleanup of
+                         * threads and other resources before reconnection.
+                         */
+                        cy_mqtt_disconnect(mqtt_connection);
+                        xEventGroupClearBits(mqtt_status_events, MQTT_STATUS_CONNECTED);
+                        conn_timing_begin();
+                        print_event_stats();
+
+                        /* The MQTT connecting state also reconnects the Wi-Fi
+                         * if that connection was lost.
+                         */
+                        printf("Initiating MQTT Reconnection...\n");
+                        conn_state_enter(CONN_STATE_MQTT_CONNECTING);
+                        break;
+                    }
+
+                    default:
+                        break;
+                }
+                break;
             }
+
+            default:
+                break;
         }
     }
 
     /* Cleanup section: Delete subscriber and publisher tasks and perform
-     * cleanup for various operations based on the status_flag.
+     * cleanup for various operations based on 'mqtt_status_events'.
      */
     exit_cleanup:
     printf("\nTerminating Publisher and Subscriber tasks...\n");
+    stack_calibration_stop();
+#if (APP_EVENT_LOOP_ENABLED != 0)
+    if (app_event_loop_task_handle != NULL)
+    {
+        vTaskDelete(app_event_loop_task_handle);
+    }
+#endif
     if (subscriber_task_handle != NULL)
     {
         vTaskDelete(subscriber_task_handle);
@@ -316,14 +494,197 @@ void mqtt_client_task(void *pvParameters)
     vTaskDelete(NULL);
 }
 
+/******************************************************************************
+ * Function Name: mqtt_wait_status
+ ******************************************************************************
+ * Summary:
+ *  Function that blocks the calling task until all the given status bits
+ *  are set, e.g. until the MQTT connection is ready. With a timeout of 0, it
+ *  only checks the bits. Can be called from any task once the MQTT client
+ *  task has started.
+ *
+ * Parameters:
+ *  EventBits_t bits : MQTT_STATUS_* bits to wait for
+ *  TickType_t ticks : maximum time to wait
+ *
+ * Return:
+ *  bool : true if all the bits are set, false on timeout
+ *
+ ******************************************************************************/
+bool mqtt_wait_status(EventBits_t bits, TickType_t ticks)
+{
+    if (mqtt_status_events == NULL)
+    {
+        return false;
+    }
+
+    return ((xEventGroupWaitBits(mqtt_status_events, bits, pdFALSE, pdTRUE, ticks) & bits) == bits);
+}
+
+/******************************************************************************
+ * Function Name: create_app_tasks
+ ******************************************************************************
+ * Summary:
+ *  Function that creates the subscriber, publisher and PAS CO2 tasks after
+ *  the first successful MQTT connection. The APP_EVENT_LOOP_ENABLED build
+ *  creates the event loop task instead of the subscriber and publisher.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  cy_rslt_t : CY_RSLT_SUCCESS if all tasks were created, else an error code
+ *
+ ******************************************************************************/
+static cy_rslt_t create_app_tasks(void)
+{
+#if (APP_EVENT_LOOP_ENABLED != 0)
+    /* Create the event loop task, it subscribes when it starts. */
+    if (pdPASS != APP_TASK_CREATE(app_event_loop_task, APP_EVENT_LOOP_TASK_NAME, APP_EVENT_LOOP_TASK_STACK_SIZE,
+                                  NULL, APP_EVENT_LOOP_TASK_PRIORITY, &app_event_loop_task_handle))
+    {
+        printf("Failed to create the '%s' task!\n", APP_EVENT_LOOP_TASK_NAME);
+        return ~CY_RSLT_SUCCESS;
+    }
+
+    /* Wait for the subscribe operation to complete and for the queues of
+     * the publisher and the subscriber.
+     */
+    (void)mqtt_wait_status(MQTT_STATUS_SUBSCRIBER_READY | MQTT_STATUS_PUBLISHER_READY, portMAX_DELAY);
+#else
+    /* Create the subscriber task. */
+    if (pdPASS != APP_TASK_CREATE(subscriber_task, "Subscriber task", SUBSCRIBER_TASK_STACK_SIZE,
+                                  NULL, SUBSCRIBER_TASK_PRIORITY, &subscriber_task_handle))
+    {
+        printf("Failed to create the Subscriber task!\n");
+        return ~CY_RSLT_SUCCESS;
+    }
+
+    /* Wait for the subscribe operation to complete and for the queue of the
+     * subscriber, which is used on each reconnection.
+     */
+    (void)mqtt_wait_status(MQTT_STATUS_SUBSCRIBER_READY, portMAX_DELAY);
+
+    /* Create the publisher task. */
+    if (pdPASS != APP_TASK_CREATE(publisher_task, "Publisher task", PUBLISHER_TASK_STACK_SIZE,
+                                  NULL, PUBLISHER_TASK_PRIORITY, &publisher_task_handle))
+    {
+        printf("Failed to create Publisher task!\n");
+        return ~CY_RSLT_SUCCESS;
+    }
+
+    /* The sensor task publishes to the queue of the publisher. */
+    (void)mqtt_wait_status(MQTT_STATUS_PUBLISHER_READY, portMAX_DELAY);
+#endif /* APP_EVENT_LOOP_ENABLED */
+
+    /* Initializes context object of PASCO2 library, sets default */
+    /* parameters values for sensor and continuously acquire data from sensor. */
+    if (pdPASS != APP_TASK_CREATE(pasco2_task, PASCO2_TASK_NAME, PASCO2_TASK_STACK_SIZE,
+                                  NULL, PASCO2_TASK_PRIORITY, &pasco2_task_handle))
+    {
+        printf("Failed to create '%s' task!\n", PASCO2_TASK_NAME);
+        return ~CY_RSLT_SUCCESS;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/******************************************************************************
+ * Function Name: conn_state_enter
+ ******************************************************************************
+ * Summary:
+ *  Function that moves the connection state machine to a new state and
+ *  updates the timing metrics of the state that is left.
+ *
+ * Parameters:
+ *  conn_state_t new_state : state to enter
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void conn_state_enter(conn_state_t new_state)
+{
+    const uint64_t now_ms = time_sync_get_mono_ms();
+    const uint32_t spent_ms = (uint32_t)(now_ms - conn_state_entered_ms);
+    conn_state_metrics_t *metrics = &conn_state_metrics[conn_state];
+
+    metrics->last_ms = spent_ms;
+    metrics->total_ms += spent_ms;
+    if (spent_ms > metrics->max_ms)
+    {
+        metrics->max_ms = spent_ms;
+    }
+
+    printf("Connection state %s -> %s after %lu ms and %lu attempts\n",
+           conn_state_names[conn_state], conn_state_names[new_state],
+           (unsigned long)spent_ms, (unsigned long)conn_state_attempts);
+
+    conn_state = new_state;
+    conn_state_entered_ms = now_ms;
+    conn_state_attempts = 0;
+    conn_state_metrics[new_state].entries++;
+}
+
+/******************************************************************************
+ * Function Name: conn_retry_delay
+ ******************************************************************************
+ * Summary:
+ *  Function that waits for the next backoff delay after a failed connection
+ *  attempt.
+ *
+ * Parameters:
+ *  backoff_t *backoff : backoff of the failed connection
+ *  const char *name : name of the connection used in the log message
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void conn_retry_delay(backoff_t *backoff, const char *name)
+{
+    const uint32_t delay_ms = backoff_next_ms(backoff);
+
+    printf("%s connection attempt %lu failed. Retrying in %lu ms\n",
+           name, (unsigned long)conn_state_attempts, (unsigned long)delay_ms);
+    vTaskDelay(pdMS_TO_TICKS(delay_ms));
+}
+
+/******************************************************************************
+ * Function Name: print_event_stats
+ ******************************************************************************
+ * Summary:
+ *  Function that reports a disconnection together with the counters of the
+ *  event ring, which tell whether events from the MQTT callback were merged
+ *  or lost.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void print_event_stats(void)
+{
+    mqtt_event_stats_t stats;
+
+    mqtt_event_get_stats(&stats);
+    printf("\nDisconnected from MQTT broker! Events: %lu posted, %lu coalesced, "
+           "%lu overflowed, max depth %lu, %lu messages dropped\n",
+           (unsigned long)stats.posted, (unsigned long)stats.coalesced,
+           (unsigned long)stats.overflow, (unsigned long)stats.max_depth,
+           (unsigned long)stats.msg_dropped);
+}
+
 /******************************************************************************
  * Function Name: wifi_connect
  ******************************************************************************
  * Summary:
- *  Function that initiates connection to the Wi-Fi Access Point using the
- *  specified SSID and PASSWORD. The connection is retried a maximum of
- *  'MAX_WIFI_CONN_RETRIES' times with interval of 'WIFI_CONN_RETRY_INTERVAL_MS'
- *  milliseconds.
+ *  Function that makes one attempt to connect to the Wi-Fi Access Point using
+ *  the specified SSID and PASSWORD. The last AP is rejoined directly first,
+ *  see wifi_rejoin.c, and searched by its SSID if that fails. The retries are
+ *  handled by the connection state machine.
  *
  * Parameters:
  *  void
@@ -338,6 +699,8 @@ static cy_rslt_t wifi_connect(void)
     cy_rslt_t result = CY_RSLT_SUCCESS;
     cy_wcm_connect_params_t connect_param;
     cy_wcm_ip_address_t ip_address;
+    cy_wcm_ip_setting_t rejoin_ip_settings;
+    bool rejoin;
 
     /* Check if Wi-Fi connection is already established. */
     if (cy_wcm_is_connected_to_ap() == 0)
@@ -350,38 +713,51 @@ static cy_rslt_t wifi_connect(void)
 
         printf("\nConnecting to Wi-Fi AP '%s'\n\n", connect_param.ap_credentials.SSID);
 
-        /* Connect to the Wi-Fi AP. */
-        for (uint32_t retry_count = 0; retry_count < MAX_WIFI_CONN_RETRIES; retry_count++)
+        /* Connect to the Wi-Fi AP. The DHCP phase starts when the link
+         * comes up, see conn_timing.c.
+         */
+        rejoin = wifi_rejoin_prepare(&connect_param, &rejoin_ip_settings);
+        conn_timing_start(CONN_PHASE_WIFI_ASSOC);
+        result = cy_wcm_connect_ap(&connect_param, &ip_address);
+        conn_timing_end(CONN_PHASE_WIFI_ASSOC);
+        conn_timing_end(CONN_PHASE_DHCP);
+
+        if ((result != CY_RSLT_SUCCESS) && rejoin)
         {
+            /* The AP may have changed, fall back to a full connect. */
+            printf("Rejoin failed with error code 0x%0X, searching the SSID.\n", (int)result);
+            wifi_rejoin_invalidate();
+            memset(connect_param.BSSID, 0, sizeof(connect_param.BSSID));
+            connect_param.static_ip_settings = NULL;
+
+            conn_timing_start(CONN_PHASE_WIFI_ASSOC);
             result = cy_wcm_connect_ap(&connect_param, &ip_address);
+            conn_timing_end(CONN_PHASE_WIFI_ASSOC);
+            conn_timing_end(CONN_PHASE_DHCP);
+        }
 
-            if (result == CY_RSLT_SUCCESS)
-            {
-                printf("\nSuccessfully connected to Wi-Fi network '%s'.\n", connect_param.ap_credentials.SSID);
+        if (result == CY_RSLT_SUCCESS)
+        {
+            printf("\nSuccessfully connected to Wi-Fi network '%s'.\n", connect_param.ap_credentials.SSID);
 
-                /* Set the appropriate bit in the status_flag to denote
-                 * successful Wi-Fi connection, print the assigned IP address.
-                 */
-                status_flag |= WIFI_CONNECTED;
-                if (ip_address.version == CY_WCM_IP_VER_V4)
-                {
-                    printf("IPv4 Address Assigned: %s\n\n", ip4addr_ntoa((const ip4_addr_t *) &ip_address.ip.v4));
-                }
-                else if (ip_address.version == CY_WCM_IP_VER_V6)
-                {
-                    printf("IPv6 Address Assigned: %s\n\n", ip6addr_ntoa((const ip6_addr_t *) &ip_address.ip.v6));
-                }
-                return result;
+            /* Set the appropriate bit in 'mqtt_status_events' to denote
+             * successful Wi-Fi connection, print the assigned IP address.
+             */
+            xEventGroupSetBits(mqtt_status_events, WIFI_CONNECTED);
+            wifi_rejoin_store(&ip_address, (connect_param.static_ip_settings == NULL));
+            if (ip_address.version == CY_WCM_IP_VER_V4)
+            {
+                printf("IPv4 Address Assigned: %s\n\n", ip4addr_ntoa((const ip4_addr_t *) &ip_address.ip.v4));
+            }
+            else if (ip_address.version == CY_WCM_IP_VER_V6)
+            {
+                printf("IPv6 Address Assigned: %s\n\n", ip6addr_ntoa((const ip6_addr_t *) &ip_address.ip.v6));
             }
-
-            printf("Connection to Wi-Fi network failed with error code 0x%0X. Retrying in %d ms. Retries left: %d\n",
-                (int)result, WIFI_CONN_RETRY_INTERVAL_MS, (int)(MAX_WIFI_CONN_RETRIES - retry_count - 1));
-            vTaskDelay(pdMS_TO_TICKS(WIFI_CONN_RETRY_INTERVAL_MS));
         }
-
-        printf("\nExceeded maximum Wi-Fi connection attempts!\n");
-        printf("Wi-Fi connection failed after retrying for %d mins\n\n",
-            (int)(WIFI_CONN_RETRY_INTERVAL_MS * MAX_WIFI_CONN_RETRIES) / 60000u);
+        else
+        {
+            printf("Connection to Wi-Fi network failed with error code 0x%0X.\n", (int)result);
+        }
     }
     return result;
 }
@@ -390,9 +766,10 @@ static cy_rslt_t wifi_connect(void)
  * Function Name: mqtt_init
  ******************************************************************************
  * Summary:
- *  Function that initializes the MQTT library and creates an instance for the
- *  MQTT client. The network buffer needed by the MQTT library for MQTT send
- *  send and receive operations is also allocated by this function.
+ *  Function that initializes the MQTT library. The network buffer needed by
+ *  the MQTT library for MQTT send and receive operations is also allocated by
+ *  this function. The MQTT client instance is created by the first connect
+ *  attempt, once the broker address is known.
  *
  * Parameters:
  *  void
@@ -412,19 +789,16 @@ static cy_rslt_t mqtt_init(void)
     CHECK_RESULT(result, LIBS_INITIALIZED, "MQTT library initialization failed!\n\n");
 
     /* Allocate buffer for MQTT send and receive operations. */
+#if (APP_STATIC_ALLOCATION != 0)
+    mqtt_network_buffer = mqtt_network_buffer_storage;
+#else
     mqtt_network_buffer = (uint8_t *) pvPortMalloc(sizeof(uint8_t) * MQTT_NETWORK_BUFFER_SIZE);
+#endif
     if(mqtt_network_buffer == NULL)
     {
         result = ~CY_RSLT_SUCCESS;
     }
     CHECK_RESULT(result, BUFFER_INITIALIZED, "Network Buffer allocation failed!\n\n");
-
-    /* Create the MQTT client instance. */
-    result = cy_mqtt_create(mqtt_network_buffer, MQTT_NETWORK_BUFFER_SIZE,
-                            security_info, &broker_info,
-                            (cy_mqtt_callback_t)mqtt_event_callback, NULL,
-                            &mqtt_connection);
-    CHECK_RESULT(result, MQTT_INSTANCE_CREATED, "MQTT instance creation failed!\n\n");
     printf("MQTT library initialization successful.\n\n");
 
     return result;
@@ -434,9 +808,10 @@ static cy_rslt_t mqtt_init(void)
  * Function Name: mqtt_connect
  ******************************************************************************
  * Summary:
- *  Function that initiates MQTT connect operation. The connection is retried
- *  a maximum of 'MAX_MQTT_CONN_RETRIES' times with interval of
- *  'MQTT_CONN_RETRY_INTERVAL_MS' milliseconds.
+ *  Function that makes one MQTT connect attempt to the broker selected by
+ *  broker_select_next(). The result is reported back, so that the next
+ *  attempt fails over to another broker. The retries and a lost Wi-Fi
+ *  connection are handled by the connection state machine.
  *
  * Parameters:
  *  void
@@ -451,9 +826,22 @@ static cy_rslt_t mqtt_connect(void)
     /* Variable to indicate status of various operations. */
     cy_rslt_t result = CY_RSLT_SUCCESS;
 
+    /* Selected MQTT broker, its address and whether it was resolved now */
+    const mqtt_broker_endpoint_t *endpoint = broker_select_next();
+    cy_socket_ip_address_t broker_address;
+    bool from_cache = false;
+
+    /* Start of the connection, to measure the latency of the broker */
+    TickType_t connect_start_tick;
+
     /* MQTT client identifier string. */
     char mqtt_client_identifier[(MQTT_CLIENT_IDENTIFIER_MAX_LEN + 1)] = MQTT_CLIENT_IDENTIFIER;
 
+#if ENABLE_LWT_MESSAGE
+    /* Expanded topic of the will message */
+    mqtt_topic_id_t will_topic;
+#endif /* ENABLE_LWT_MESSAGE */
+
     /* Configure the user credentials as a part of MQTT Connect packet */
     if (strlen(MQTT_USERNAME) > 0)
     {
@@ -475,49 +863,167 @@ static cy_rslt_t mqtt_connect(void)
     connection_info.client_id = mqtt_client_identifier;
     connection_info.client_id_len = strlen(mqtt_client_identifier);
 
-    printf("\nMQTT client '%.*s' connecting to MQTT broker '%.*s'...\n\n",
+    /* Expand the topic templates with the client identifier of this
+     * connection.
+     */
+    mqtt_topic_set_client_id(mqtt_client_identifier);
+#if ENABLE_LWT_MESSAGE
+    will_topic = mqtt_topic_intern(MQTT_WILL_TOPIC_NAME);
+    if (will_topic == MQTT_TOPIC_INVALID)
+    {
+        printf("Invalid MQTT will topic '%s'!\n", MQTT_WILL_TOPIC_NAME);
+        CY_ASSERT(0);
+        return ~CY_RSLT_SUCCESS;
+    }
+    connection_info.will_info->topic = mqtt_topic_name(will_topic);
+    connection_info.will_info->topic_len = mqtt_topic_len(will_topic);
+#endif /* ENABLE_LWT_MESSAGE */
+
+    /* Look up the broker address. A fresh cached address skips the DNS
+     * lookup, so the DNS phase is close to zero on a reconnect.
+     */
+    conn_timing_start(CONN_PHASE_DNS);
+    result = dns_cache_resolve(endpoint->hostname, &broker_address, &from_cache);
+    conn_timing_end(CONN_PHASE_DNS);
+    if (result != CY_RSLT_SUCCESS)
+    {
+        printf("DNS lookup of the MQTT broker '%s' failed with error code 0x%0X.\n",
+               endpoint->hostname, (int)result);
+        broker_select_report(endpoint, false, 0);
+        return result;
+    }
+
+    result = mqtt_set_broker_address(endpoint, &broker_address);
+    if (result != CY_RSLT_SUCCESS)
+    {
+        return result;
+    }
+
+    printf("\nMQTT client '%.*s' connecting to MQTT broker '%s' at %s:%u%s...\n\n",
            connection_info.client_id_len,
            connection_info.client_id,
-           broker_info.hostname_len,
-           broker_info.hostname);
+           endpoint->hostname,
+           broker_ip_str,
+           (unsigned int)endpoint->port,
+           from_cache ? " (cached)" : "");
+
+    /* Disconnections reported before this connection are stale. The events
+     * are discarded before the connection is established, so a disconnection
+     * of the new connection is kept even if it is reported right away.
+     */
+    mqtt_event_reset();
 
-    for (uint32_t retry_count = 0; retry_count < MAX_MQTT_CONN_RETRIES; retry_count++)
+    /* Establish the MQTT connection, unless a broker outage is injected. */
+    conn_timing_start(CONN_PHASE_MQTT_CONNECT);
+    connect_start_tick = xTaskGetTickCount();
+    if (fault_injection_connect_blocked())
     {
-        if (cy_wcm_is_connected_to_ap() == 0)
+        result = ~CY_RSLT_SUCCESS;
+    }
+    else
+    {
+        result = cy_mqtt_connect(mqtt_connection, &connection_info);
+    }
+    conn_timing_end(CONN_PHASE_MQTT_CONNECT);
+    broker_select_report(endpoint, (result == CY_RSLT_SUCCESS),
+                         (uint32_t)(xTaskGetTickCount() - connect_start_tick) * portTICK_PERIOD_MS);
+
+    if (result == CY_RSLT_SUCCESS)
+    {
+        printf("\nMQTT connection successful.\n\n");
+
+        /* Set the appropriate bit in 'mqtt_status_events' to denote successful
+         * MQTT connection.
+         */
+        xEventGroupSetBits(mqtt_status_events, MQTT_STATUS_CONNECTED);
+
+        /* Injected loss of the new connection, reported the same way as by
+         * the MQTT event callback. Only if FAULT_INJECTION_ENABLED is set.
+         */
+        if (fault_injection_drop_connected())
         {
-            printf("Unexpectedly disconnected from Wi-Fi network! Initiating Wi-Fi reconnection...\n");
-            status_flag &= ~(WIFI_CONNECTED);
+            xEventGroupClearBits(mqtt_status_events, MQTT_STATUS_CONNECTED);
+            (void)mqtt_event_post(HANDLE_DISCONNECTION);
+        }
+    }
+    else
+    {
+        printf("MQTT connection failed with error code 0x%0X.\n", (int)result);
 
-            /* Initiate Wi-Fi reconnection. */
-            result = wifi_connect();
-            if (CY_RSLT_SUCCESS != result)
-            {
-                return result;
-            }
+        /* The broker may have moved, resolve it again on the next attempt. */
+        if (from_cache)
+        {
+            dns_cache_invalidate(endpoint->hostname);
         }
+    }
 
-        /* Establish the MQTT connection. */
-        result = cy_mqtt_connect(mqtt_connection, &connection_info);
+    return result;
+}
 
-        if (result == CY_RSLT_SUCCESS)
-        {
-            printf("\nMQTT connection successful.\n\n");
+/******************************************************************************
+ * Function Name: mqtt_set_broker_address
+ ******************************************************************************
+ * Summary:
+ *  Function that points the MQTT client instance to the given broker and
+ *  address. The MQTT library keeps the broker information of the instance,
+ *  so the instance is deleted and created again if the broker or its
+ *  address changed.
+ *
+ * Parameters:
+ *  const mqtt_broker_endpoint_t *endpoint : broker to connect to
+ *  const cy_socket_ip_address_t *address : IPv4 address of the broker
+ *
+ * Return:
+ *  cy_rslt_t : CY_RSLT_SUCCESS if the instance uses the address, else an
+ *              error code indicating the failure.
+ *
+ ******************************************************************************/
+static cy_rslt_t mqtt_set_broker_address(const mqtt_broker_endpoint_t *endpoint,
+                                         const cy_socket_ip_address_t *address)
+{
+    /* The address is stored in network byte order */
+    const uint8_t *octets = (const uint8_t *)&address->ip.v4;
+    char ip_str[BROKER_IP_STR_SIZE];
+    cy_rslt_t result;
 
-            /* Set the appropriate bit in the status_flag to denote successful
-             * MQTT connection, and return the result to the calling function.
-             */
-            status_flag |= MQTT_CONNECTION_SUCCESS;
-            return result;
+    snprintf(ip_str, sizeof(ip_str), "%u.%u.%u.%u",
+             octets[0], octets[1], octets[2], octets[3]);
+
+    if ((xEventGroupGetBits(mqtt_status_events) & MQTT_INSTANCE_CREATED) != 0)
+    {
+        if ((endpoint == broker_endpoint) && (strcmp(ip_str, broker_ip_str) == 0))
+        {
+            return CY_RSLT_SUCCESS;
         }
 
-        printf("MQTT connection failed with error code 0x%0X. Retrying in %d ms. Retries left: %d\n",
-               (int)result, MQTT_CONN_RETRY_INTERVAL_MS, (int)(MAX_MQTT_CONN_RETRIES - retry_count - 1));
-        vTaskDelay(pdMS_TO_TICKS(MQTT_CONN_RETRY_INTERVAL_MS));
+        cy_mqtt_delete(mqtt_connection);
+        xEventGroupClearBits(mqtt_status_events, MQTT_INSTANCE_CREATED);
     }
 
-    printf("\nExceeded maximum MQTT connection attempts\n");
-    printf("MQTT connection failed after retrying for %d mins\n\n",
-           (int)(MQTT_CONN_RETRY_INTERVAL_MS * MAX_MQTT_CONN_RETRIES) / 60000u);
+    broker_endpoint = endpoint;
+    memcpy(broker_ip_str, ip_str, sizeof(broker_ip_str));
+    broker_info.hostname = broker_ip_str;
+    broker_info.hostname_len = strlen(broker_ip_str);
+    broker_info.port = endpoint->port;
+
+    /* Select and verify the certificate of the broker by its own SNI
+     * hostname, or by its hostname if it has none.
+     */
+    if (security_info != NULL)
+    {
+        const char *sni_hostname = (endpoint->sni_hostname != NULL) ? endpoint->sni_hostname
+                                                                    : endpoint->hostname;
+        security_info->sni_host_name = sni_hostname;
+        security_info->sni_host_name_size = strlen(sni_hostname) + 1;
+    }
+
+    /* Create the MQTT client instance. */
+    result = cy_mqtt_create(mqtt_network_buffer, MQTT_NETWORK_BUFFER_SIZE,
+                            security_info, &broker_info,
+                            (cy_mqtt_callback_t)mqtt_event_callback, NULL,
+                            &mqtt_connection);
+    CHECK_RESULT(result, MQTT_INSTANCE_CREATED, "MQTT instance creation failed!\n\n");
+
     return result;
 }
 
@@ -528,10 +1034,12 @@ static cy_rslt_t mqtt_connect(void)
  *  Callback invoked by the MQTT library for events like MQTT disconnection,
  *  incoming MQTT subscription messages from the MQTT broker.
  *    1. In case of MQTT disconnection, the MQTT client task is communicated
- *       about the disconnection using a message queue.
+ *       about the disconnection using the event ring.
  *    2. When an MQTT subscription message is received, the subscriber callback
  *       function implemented in subscriber_task.c is invoked to handle the
  *       incoming MQTT message.
+ *  The callback runs in the context of the MQTT library and never blocks:
+ *  it neither waits for the MQTT client task nor prints.
  *
  * Parameters:
  *  cy_mqtt_t mqtt_handle : MQTT handle corresponding to the MQTT event (unused)
@@ -545,7 +1053,6 @@ static cy_rslt_t mqtt_connect(void)
 void mqtt_event_callback(cy_mqtt_t mqtt_handle, cy_mqtt_event_t event, void *user_data)
 {
     cy_mqtt_publish_info_t *received_msg;
-    mqtt_task_cmd_t mqtt_task_cmd;
 
     (void) mqtt_handle;
     (void) user_data;
@@ -555,25 +1062,20 @@ void mqtt_event_callback(cy_mqtt_t mqtt_handle, cy_mqtt_event_t event, void *use
         case CY_MQTT_EVENT_TYPE_DISCONNECT:
         {
             /* Clear the status flag bit to indicate MQTT disconnection. */
-            status_flag &= ~(MQTT_CONNECTION_SUCCESS);
+            xEventGroupClearBits(mqtt_status_events, MQTT_STATUS_CONNECTED);
 
             /* MQTT connection with the MQTT broker is broken as the client
-             * is unable to communicate with the broker. Set the appropriate
-             * command to be sent to the MQTT task.
-             */
-            printf("\nUnexpectedly disconnected from MQTT broker!\n");
-            mqtt_task_cmd = HANDLE_DISCONNECTION;
-
-            /* Send the message to the MQTT client task to handle the
-             * disconnection.
+             * is unable to communicate with the broker. Post the event to the
+             * MQTT client task, which reports and handles the disconnection.
+             * Repeated disconnections are merged into the pending one.
              */
-            xQueueSend(mqtt_task_q, &mqtt_task_cmd, portMAX_DELAY);
+            (void)mqtt_event_post(HANDLE_DISCONNECTION);
             break;
         }
 
         case CY_MQTT_EVENT_TYPE_SUBSCRIPTION_MESSAGE_RECEIVE:
         {
-            status_flag |= MQTT_MSG_RECEIVED;
+            xEventGroupSetBits(mqtt_status_events, MQTT_MSG_RECEIVED);
 
             /* Incoming MQTT message has been received. Send this message to
              * the subscriber callback function to handle it.
@@ -584,8 +1086,7 @@ void mqtt_event_callback(cy_mqtt_t mqtt_handle, cy_mqtt_event_t event, void *use
         }
         default :
         {
-            /* Unknown MQTT event */
-            printf("\nUnknown Event received from MQTT callback!\n");
+            /* Unknown MQTT event, ignored */
             break;
         }
     }
@@ -630,7 +1131,7 @@ static cy_rslt_t mqtt_get_unique_client_identifier(char *mqtt_client_identifier)
  ******************************************************************************
  * Summary:
  *  Function that invokes the deinit and cleanup functions for various
- *  operations based on the status_flag.
+ *  operations based on 'mqtt_status_events'.
  *
  * Parameters:
  *  void
@@ -641,8 +1142,10 @@ static cy_rslt_t mqtt_get_unique_client_identifier(char *mqtt_client_identifier)
  ******************************************************************************/
 static void cleanup(void)
 {
+    const EventBits_t status_flag = xEventGroupGetBits(mqtt_status_events);
+
     /* Disconnect the MQTT connection if it was established. */
-    if (status_flag & MQTT_CONNECTION_SUCCESS)
+    if (status_flag & MQTT_STATUS_CONNECTED)
     {
         printf("Disconnecting from the MQTT Broker...\n");
         cy_mqtt_disconnect(mqtt_connection);
@@ -653,10 +1156,12 @@ static void cleanup(void)
         cy_mqtt_delete(mqtt_connection);
     }
     /* Deallocate the network buffer. */
+#if (APP_STATIC_ALLOCATION == 0)
     if (status_flag & BUFFER_INITIALIZED)
     {
         vPortFree((void *) mqtt_network_buffer);
     }
+#endif
     /* Deinit the MQTT library. */
     if (status_flag & LIBS_INITIALIZED)
     {
@@ -26,9 +26,14 @@
 
 #pragma once
 
+#include <stdbool.h>
+
 #include "FreeRTOS.h"
+#include "event_groups.h"
 #include "queue.h"
+#include "task.h"
 #include "cy_mqtt_api.h"
+#include "stack_size_config.h"
 
 
 /*******************************************************************************
@@ -36,7 +41,16 @@
 *******************************************************************************/
 /* Task parameters for MQTT Client Task. */
 #define MQTT_CLIENT_TASK_PRIORITY       (2)
+#ifndef MQTT_CLIENT_TASK_STACK_SIZE
 #define MQTT_CLIENT_TASK_STACK_SIZE     (1024 * 2)
+#endif
+
+/* Bits of 'mqtt_status_events' that other tasks can wait for. The other
+ * bits of the event group are used by the MQTT client task only.
+ */
+#define MQTT_STATUS_CONNECTED           (1lu << 5)
+#define MQTT_STATUS_SUBSCRIBER_READY    (1lu << 8)
+#define MQTT_STATUS_PUBLISHER_READY     (1lu << 9)
 
 /*******************************************************************************
 * Global Variables
@@ -49,15 +63,38 @@ typedef enum
     HANDLE_DISCONNECTION
 } mqtt_task_cmd_t;
 
+/* States of the connection state machine of the MQTT Client Task. */
+typedef enum
+{
+    CONN_STATE_WIFI_CONNECTING,
+    CONN_STATE_MQTT_CONNECTING,
+    CONN_STATE_CONNECTED,
+    CONN_STATE_COUNT
+} conn_state_t;
+
+/* Timing of one connection state, updated on every state transition. */
+typedef struct
+{
+    uint32_t entries;       /* Number of times the state was entered */
+    uint32_t attempts;      /* Connection attempts made in the state */
+    uint32_t last_ms;       /* Time spent in the state on the last visit */
+    uint32_t max_ms;        /* Longest visit of the state */
+    uint64_t total_ms;      /* Time spent in the state since boot */
+} conn_state_metrics_t;
+
 /*******************************************************************************
  * Extern variables
  ******************************************************************************/
 extern cy_mqtt_t mqtt_connection;
-extern QueueHandle_t mqtt_task_q;
+extern TaskHandle_t mqtt_client_task_handle;
+extern EventGroupHandle_t mqtt_status_events;
+extern conn_state_t conn_state;
+extern conn_state_metrics_t conn_state_metrics[CONN_STATE_COUNT];
 
 /*******************************************************************************
 * Function Prototypes
 *******************************************************************************/
 void mqtt_client_task(void *pvParameters);
+bool mqtt_wait_status(EventBits_t bits, TickType_t ticks);
 
 /* [] END OF FILE */
@@ -0,0 +1,304 @@
+/******************************************************************************
+ * File Name:   mqtt_topic.c
+ *
+ * Description: This file contains the table of the MQTT topics. The topics are
+ *              given as templates, e.g. 'site/{device_id}/co2', which are expanded once
+ *              into the table with their lengths, so that publishing a message does no
+ *              string formatting. The messages refer to the topics by a small handle.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "cyhal.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "mqtt_topic.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Placeholders of the topic templates */
+#define TOPIC_VAR_CLIENT_ID         "{client_id}"
+#define TOPIC_VAR_DEVICE_ID         "{device_id}"
+
+/* Longest client identifier stored for the expansion, including the null */
+#define TOPIC_CLIENT_ID_MAX_LEN     (32u)
+
+/* Length of the '{device_id}' value, the unique die ID in hex */
+#define TOPIC_DEVICE_ID_LEN         (16u)
+
+/*******************************************************************************
+ * Typedefines
+ ******************************************************************************/
+typedef struct
+{
+    const char *topic_template;
+    char name[MQTT_TOPIC_MAX_LEN];
+    uint16_t len;
+} mqtt_topic_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+/* Interned topics. The table is written in a critical section, by the
+ * publisher, subscriber and MQTT client tasks when they intern their topics
+ * and by the MQTT client task when the client identifier changes before a
+ * connection. The publisher and subscriber read it without locking: a
+ * topic only changes while the connection is down, so a publish that reads
+ * it meanwhile fails anyway.
+ */
+static mqtt_topic_t mqtt_topics[MQTT_TOPIC_MAX];
+static uint32_t mqtt_topic_count = 0;
+
+/* Values of the placeholders, '{device_id}' is the unique die ID in hex */
+static char topic_client_id[TOPIC_CLIENT_ID_MAX_LEN];
+static char topic_device_id[TOPIC_DEVICE_ID_LEN + 1u];
+static bool topic_vars_set = false;
+
+/*******************************************************************************
+ * Function Name: mqtt_topic_max_len
+ *******************************************************************************
+ * Summary:
+ *   Returns the length of a topic template expanded with the longest values
+ *   of the placeholders, so that a topic too long for its buffer is found
+ *   when it is interned rather than when it is used.
+ *
+ * Parameters:
+ *   topic_template: null terminated topic template
+ *
+ * Return:
+ *   size_t: longest length of the expanded topic without the null
+ ******************************************************************************/
+static size_t mqtt_topic_max_len(const char *topic_template)
+{
+    const char *source = topic_template;
+    size_t len = 0;
+
+    while (*source != '\0')
+    {
+        if (strncmp(source, TOPIC_VAR_CLIENT_ID, sizeof(TOPIC_VAR_CLIENT_ID) - 1u) == 0)
+        {
+            len += TOPIC_CLIENT_ID_MAX_LEN - 1u;
+            source += sizeof(TOPIC_VAR_CLIENT_ID) - 1u;
+        }
+        else if (strncmp(source, TOPIC_VAR_DEVICE_ID, sizeof(TOPIC_VAR_DEVICE_ID) - 1u) == 0)
+        {
+            len += TOPIC_DEVICE_ID_LEN;
+            source += sizeof(TOPIC_VAR_DEVICE_ID) - 1u;
+        }
+        else
+        {
+            len++;
+            source++;
+        }
+    }
+
+    return len;
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_topic_expand
+ *******************************************************************************
+ * Summary:
+ *   Expands a topic template into the buffer of the topic. The template was
+ *   checked with mqtt_topic_max_len(), so the expanded topic fits.
+ *
+ * Parameters:
+ *   topic: topic with its template set
+ *
+ * Return:
+ *   void
+ ******************************************************************************/
+static void mqtt_topic_expand(mqtt_topic_t *topic)
+{
+    const char *source = topic->topic_template;
+    size_t len = 0;
+
+    while (*source != '\0')
+    {
+        const char *value;
+        size_t value_len;
+
+        if (strncmp(source, TOPIC_VAR_CLIENT_ID, sizeof(TOPIC_VAR_CLIENT_ID) - 1u) == 0)
+        {
+            value = topic_client_id;
+            value_len = strlen(topic_client_id);
+            source += sizeof(TOPIC_VAR_CLIENT_ID) - 1u;
+        }
+        else if (strncmp(source, TOPIC_VAR_DEVICE_ID, sizeof(TOPIC_VAR_DEVICE_ID) - 1u) == 0)
+        {
+            value = topic_device_id;
+            value_len = strlen(topic_device_id);
+            source += sizeof(TOPIC_VAR_DEVICE_ID) - 1u;
+        }
+        else
+        {
+            /* Other characters are copied unchanged */
+            value = source;
+            value_len = 1u;
+            source++;
+        }
+
+        memcpy(&topic->name[len], value, value_len);
+        len += value_len;
+    }
+
+    topic->name[len] = '\0';
+    topic->len = (uint16_t)len;
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_topic_set_client_id
+ *******************************************************************************
+ * Summary:
+ *   Sets the values of the placeholders and expands the topics interned
+ *   before. Called by the MQTT client task before each connection. With
+ *   GENERATE_UNIQUE_CLIENT_ID the identifier changes on each connection, and
+ *   the topics are expanded again, so that they match the identifier the
+ *   broker authorizes. The handles of the topics do not change.
+ *
+ * Parameters:
+ *   client_id: client identifier of the MQTT connection
+ *
+ * Return:
+ *   void
+ ******************************************************************************/
+void mqtt_topic_set_client_id(const char *client_id)
+{
+    const uint64_t unique_id = Cy_SysLib_GetUniqueId();
+
+    if (topic_vars_set && (strncmp(topic_client_id, client_id, sizeof(topic_client_id) - 1u) == 0))
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    snprintf(topic_client_id, sizeof(topic_client_id), "%s", client_id);
+    snprintf(topic_device_id, sizeof(topic_device_id), "%08lx%08lx",
+             (unsigned long)(uint32_t)(unique_id >> 32), (unsigned long)(uint32_t)unique_id);
+    topic_vars_set = true;
+
+    for (uint32_t id = 0; id < mqtt_topic_count; id++)
+    {
+        mqtt_topic_expand(&mqtt_topics[id]);
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_topic_intern
+ *******************************************************************************
+ * Summary:
+ *   Returns the handle of a topic template, adding it to the table on its
+ *   first use. The template is expanded immediately if the client
+ *   identifier is already set. The template string must remain valid.
+ *
+ * Parameters:
+ *   topic_template: null terminated topic, with optional '{client_id}' and
+ *                   '{device_id}' placeholders
+ *
+ * Return:
+ *   mqtt_topic_id_t: handle of the topic, MQTT_TOPIC_INVALID if the table is
+ *                    full or the expanded topic can be too long. The callers
+ *                    treat it as a configuration error.
+ ******************************************************************************/
+mqtt_topic_id_t mqtt_topic_intern(const char *topic_template)
+{
+    mqtt_topic_id_t id = MQTT_TOPIC_INVALID;
+
+    if (mqtt_topic_max_len(topic_template) >= MQTT_TOPIC_MAX_LEN)
+    {
+        printf("MQTT topic '%s' can be longer than %u characters!\n",
+               topic_template, (unsigned int)(MQTT_TOPIC_MAX_LEN - 1u));
+        return MQTT_TOPIC_INVALID;
+    }
+
+    taskENTER_CRITICAL();
+    for (uint32_t index = 0; index < mqtt_topic_count; index++)
+    {
+        if (strcmp(mqtt_topics[index].topic_template, topic_template) == 0)
+        {
+            id = (mqtt_topic_id_t)index;
+            break;
+        }
+    }
+
+    if ((id == MQTT_TOPIC_INVALID) && (mqtt_topic_count < MQTT_TOPIC_MAX))
+    {
+        mqtt_topics[mqtt_topic_count].topic_template = topic_template;
+        if (topic_vars_set)
+        {
+            mqtt_topic_expand(&mqtt_topics[mqtt_topic_count]);
+        }
+        id = (mqtt_topic_id_t)mqtt_topic_count++;
+    }
+    taskEXIT_CRITICAL();
+
+    if (id == MQTT_TOPIC_INVALID)
+    {
+        printf("MQTT topic table full, '%s' not added!\n", topic_template);
+    }
+
+    return id;
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_topic_name
+ *******************************************************************************
+ * Summary:
+ *   Returns the expanded string of an interned topic.
+ *
+ * Parameters:
+ *   id: handle of the topic
+ *
+ * Return:
+ *   const char *: null terminated topic, an empty string for an invalid
+ *                 handle or a topic that is not expanded yet
+ ******************************************************************************/
+const char *mqtt_topic_name(mqtt_topic_id_t id)
+{
+    return (id < mqtt_topic_count) ? mqtt_topics[id].name : "";
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_topic_len
+ *******************************************************************************
+ * Summary:
+ *   Returns the length of an interned topic, computed when it was expanded.
+ *
+ * Parameters:
+ *   id: handle of the topic
+ *
+ * Return:
+ *   uint16_t: length of the topic without the terminating null, 0 for an
+ *             invalid handle or a topic that is not expanded yet
+ ******************************************************************************/
+uint16_t mqtt_topic_len(mqtt_topic_id_t id)
+{
+    return (id < mqtt_topic_count) ? mqtt_topics[id].len : 0u;
+}
+
+/* [] END OF FILE */
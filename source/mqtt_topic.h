@@ -0,0 +1,65 @@
+/******************************************************************************
+ * File Name:   mqtt_topic.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *              in mqtt_topic.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Number of distinct topics the application publishes and subscribes on */
+#define MQTT_TOPIC_MAX              (8u)
+
+/* Longest expanded topic including the terminating null */
+#ifndef MQTT_TOPIC_MAX_LEN
+#define MQTT_TOPIC_MAX_LEN          (64u)
+#endif
+
+/* Returned by mqtt_topic_intern() when the table is full or the template
+ * can expand to more than MQTT_TOPIC_MAX_LEN - 1 characters, with a client
+ * identifier of up to 31 characters
+ */
+#define MQTT_TOPIC_INVALID          (0xFFu)
+
+/*******************************************************************************
+ * Typedefines
+ ******************************************************************************/
+/* Handle of an interned topic, carried by each message in place of the
+ * topic string.
+ */
+typedef uint8_t mqtt_topic_id_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+void mqtt_topic_set_client_id(const char *client_id);
+mqtt_topic_id_t mqtt_topic_intern(const char *topic_template);
+const char *mqtt_topic_name(mqtt_topic_id_t id);
+uint16_t mqtt_topic_len(mqtt_topic_id_t id);
+
+/* [] END OF FILE */
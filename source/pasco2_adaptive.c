@@ -0,0 +1,162 @@
+/******************************************************************************
+ * File Name:   pasco2_adaptive.c
+ *
+ * Description: This file contains the adaptive sampling scheduler. It selects
+ *              the PAS CO2 measurement period from a smoothed rate of change
+ *              of the CO2 concentration: the period is shortened when the
+ *              concentration changes fast and lengthened when it is stable.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#include <stdlib.h>
+
+#include "pasco2_adaptive.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Fixed-point scale of the smoothed slope */
+#define SLOPE_SCALE_SHIFT       (4)
+
+/* Weight of a new slope measurement: new = old + (measured - old) / 4 */
+#define SLOPE_FILTER_SHIFT      (2)
+
+/*******************************************************************************
+ * Function Name: pasco2_adaptive_init
+ *******************************************************************************
+ * Summary:
+ *   Resets the scheduler state and starts from the given period.
+ *
+ * Parameters:
+ *   adaptive: scheduler state
+ *   period_s: initial measurement period, clamped to the adaptive range
+ *   now_ms: current monotonic time in milliseconds
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void pasco2_adaptive_init(pasco2_adaptive_t *adaptive, uint16_t period_s, uint64_t now_ms)
+{
+    if (period_s < PASCO2_ADAPTIVE_PERIOD_MIN_S)
+    {
+        period_s = PASCO2_ADAPTIVE_PERIOD_MIN_S;
+    }
+    else if (period_s > PASCO2_ADAPTIVE_PERIOD_MAX_S)
+    {
+        period_s = PASCO2_ADAPTIVE_PERIOD_MAX_S;
+    }
+
+    *adaptive = (pasco2_adaptive_t){
+        .period_s = period_s,
+        .start_ms = now_ms
+    };
+}
+
+/*******************************************************************************
+ * Function Name: pasco2_adaptive_update
+ *******************************************************************************
+ * Summary:
+ *   Feeds a new CO2 value into the scheduler and returns the measurement
+ *   period to use from now on. A fast change halves the period immediately,
+ *   while the period is only doubled after several calm samples.
+ *
+ * Parameters:
+ *   adaptive: scheduler state
+ *   ppm: new CO2 value
+ *   now_ms: monotonic time of the CO2 value in milliseconds
+ *
+ * Return:
+ *   uint16_t: measurement period in seconds
+ ******************************************************************************/
+uint16_t pasco2_adaptive_update(pasco2_adaptive_t *adaptive, uint16_t ppm, uint64_t now_ms)
+{
+    adaptive->sample_count++;
+
+    if (adaptive->has_last && (now_ms > adaptive->last_ms))
+    {
+        const int32_t delta_ppm = (int32_t)ppm - (int32_t)adaptive->last_ppm;
+        const int32_t elapsed_ms = (int32_t)(now_ms - adaptive->last_ms);
+        const int32_t slope_x16 = (int32_t)(((int64_t)delta_ppm * 60000 * (1 << SLOPE_SCALE_SHIFT)) / elapsed_ms);
+
+        adaptive->slope_x16 += (slope_x16 - adaptive->slope_x16) / (1 << SLOPE_FILTER_SHIFT);
+
+        const int32_t abs_slope_x16 = abs(adaptive->slope_x16);
+        if (abs_slope_x16 >= (PASCO2_ADAPTIVE_RISE_PPM_PER_MIN << SLOPE_SCALE_SHIFT))
+        {
+            adaptive->calm_count = 0;
+            adaptive->period_s = adaptive->period_s / 2U;
+            if (adaptive->period_s < PASCO2_ADAPTIVE_PERIOD_MIN_S)
+            {
+                adaptive->period_s = PASCO2_ADAPTIVE_PERIOD_MIN_S;
+            }
+        }
+        else if (abs_slope_x16 <= (PASCO2_ADAPTIVE_CALM_PPM_PER_MIN << SLOPE_SCALE_SHIFT))
+        {
+            adaptive->calm_count++;
+            if (adaptive->calm_count >= PASCO2_ADAPTIVE_CALM_SAMPLES)
+            {
+                adaptive->calm_count = 0;
+                adaptive->period_s = adaptive->period_s * 2U;
+                if (adaptive->period_s > PASCO2_ADAPTIVE_PERIOD_MAX_S)
+                {
+                    adaptive->period_s = PASCO2_ADAPTIVE_PERIOD_MAX_S;
+                }
+            }
+        }
+        else
+        {
+            /* Inside the hysteresis band keep the current period */
+            adaptive->calm_count = 0;
+        }
+    }
+
+    adaptive->last_ppm = ppm;
+    adaptive->last_ms = now_ms;
+    adaptive->has_last = true;
+
+    return adaptive->period_s;
+}
+
+/*******************************************************************************
+ * Function Name: pasco2_adaptive_fixed_samples
+ *******************************************************************************
+ * Summary:
+ *   Returns the number of samples a fixed period would have taken since the
+ *   adaptive mode was enabled. Together with 'sample_count' this is the
+ *   energy proxy of the adaptive mode, as every PAS CO2 measurement costs
+ *   roughly the same energy.
+ *
+ * Parameters:
+ *   adaptive: scheduler state
+ *   fixed_period_s: configured fixed measurement period
+ *   now_ms: current monotonic time in milliseconds
+ *
+ * Return:
+ *   uint32_t: number of samples in fixed mode
+ ******************************************************************************/
+uint32_t pasco2_adaptive_fixed_samples(const pasco2_adaptive_t *adaptive, uint32_t fixed_period_s,
+                                       uint64_t now_ms)
+{
+    return (fixed_period_s == 0U) ? 0U : (uint32_t)((now_ms - adaptive->start_ms) / (fixed_period_s * 1000U));
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,77 @@
+/******************************************************************************
+ * File Name:   pasco2_adaptive.h
+ *
+ * Description: This file is the public interface of pasco2_adaptive.c
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Range of the measurement period selected by the adaptive scheduler */
+#define PASCO2_ADAPTIVE_PERIOD_MIN_S        (10U)
+#define PASCO2_ADAPTIVE_PERIOD_MAX_S        (300U)
+
+/* Absolute CO2 rate of change in ppm per minute above which the period is
+ * halved, and below which the period is doubled after
+ * 'PASCO2_ADAPTIVE_CALM_SAMPLES' consecutive samples. The gap between both
+ * thresholds is the hysteresis that prevents oscillation.
+ */
+#define PASCO2_ADAPTIVE_RISE_PPM_PER_MIN    (20)
+#define PASCO2_ADAPTIVE_CALM_PPM_PER_MIN    (5)
+#define PASCO2_ADAPTIVE_CALM_SAMPLES        (3U)
+
+/* Adaptive sampling state after power up, can be changed over MQTT */
+#define PASCO2_ADAPTIVE_ENABLED_DEFAULT     (false)
+
+/*******************************************************************************
+ * Typedefines
+ ******************************************************************************/
+/* State of the adaptive scheduler. Fixed size, O(1) per sample. */
+typedef struct
+{
+    uint16_t period_s;          /* Currently selected measurement period */
+    uint16_t last_ppm;          /* Previous CO2 value */
+    uint64_t last_ms;           /* Monotonic time of the previous CO2 value */
+    int32_t slope_x16;          /* Smoothed rate of change, ppm/min * 16 */
+    uint32_t calm_count;        /* Consecutive samples below the calm threshold */
+    bool has_last;              /* True once 'last_ppm' is valid */
+
+    /* Metrics to compare against a fixed period */
+    uint32_t sample_count;      /* Samples taken in adaptive mode */
+    uint64_t start_ms;          /* Monotonic time adaptive mode was enabled */
+} pasco2_adaptive_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+void pasco2_adaptive_init(pasco2_adaptive_t *adaptive, uint16_t period_s, uint64_t now_ms);
+uint16_t pasco2_adaptive_update(pasco2_adaptive_t *adaptive, uint16_t ppm, uint64_t now_ms);
+uint32_t pasco2_adaptive_fixed_samples(const pasco2_adaptive_t *adaptive, uint32_t fixed_period_s,
+                                       uint64_t now_ms);
+
+/* [] END OF FILE */
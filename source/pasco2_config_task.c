@@ -30,14 +30,18 @@
 #include "stdbool.h"
 #include "stdio.h"
 #include "stdlib.h"
+#include "string.h"
 
 /* Header file from library */
 #include "cy_json_parser.h"
 
 /* Header file for local tasks */
+#include "app_alloc.h"
+#include "app_event_loop.h"
 #include "pasco2_config_task.h"
 #include "pasco2_task.h"
 #include "publisher_task.h"
+#include "sensor_trace.h"
 #include "subscriber_task.h"
 
 /*******************************************************************************
@@ -45,6 +49,36 @@
  ******************************************************************************/
 TaskHandle_t pasco2_config_task_handle = NULL;
 
+/* Copy of 'sub_msg_payload' being parsed. The configurations are parsed one
+ * at a time, by the configuration task or by the event loop task.
+ */
+static char config_payload[sizeof(sub_msg_payload)];
+
+#if (APP_EVENT_LOOP_ENABLED != 0)
+/* Configuration requests handled by the event loop task */
+QueueHandle_t pasco2_config_q = NULL;
+APP_QUEUE_MEMORY(pasco2_config_q, PASCO2_CONFIG_QUEUE_LENGTH, sizeof(uint8_t));
+#endif
+
+/*******************************************************************************
+ * Function Name: json_key_equals
+ *******************************************************************************
+ * Summary:
+ *   Compares the key of a json object with a null terminated string.
+ *
+ * Parameters:
+ *   json_object: parsed json object
+ *   key: expected key
+ *
+ * Return:
+ *   true if the key matches exactly
+ ******************************************************************************/
+static bool json_key_equals(const cy_JSON_object_t *json_object, const char *key)
+{
+    return (json_object->object_string_length == strlen(key)) &&
+           (memcmp(json_object->object_string, key, json_object->object_string_length) == 0);
+}
+
 /*******************************************************************************
  * Function Name: json_parser_cb
  *******************************************************************************
@@ -74,10 +108,11 @@ static cy_rslt_t json_parser_cb(cy_JSON_object_t *json_object, void *arg)
     json_value[json_object->value_length] = '\0';
 
     publisher_data_t publisher_q_data;
-    publisher_q_data.cmd = PUBLISH_MQTT_MSG;
+    publisher_q_data.cmd = PUBLISH_MQTT_CONFIG_ACK;
+    publisher_q_data.seq = 0;
 
     /* Supported keys and values for pasco2 configuration */
-    if (memcmp(json_object->object_string, "pasco2_measurement_period", json_object->object_string_length) == 0)
+    if (json_key_equals(json_object, "pasco2_measurement_period"))
     {
         const uint16_t measurement_period = atoi(json_value);
         if ((measurement_period < XENSIV_PASCO2_MEAS_RATE_MIN) || (measurement_period > XENSIV_PASCO2_MEAS_RATE_MAX))
@@ -86,23 +121,19 @@ static cy_rslt_t json_parser_cb(cy_JSON_object_t *json_object, void *arg)
         }
         else
         {
-            xensiv_pasco2_measurement_config_t meas_config = {
-                .b.op_mode = XENSIV_PASCO2_OP_MODE_IDLE,
-                .b.boc_cfg = XENSIV_PASCO2_BOC_CFG_AUTOMATIC
-            };
-            int32_t status = xensiv_pasco2_set_measurement_config(context, meas_config);
-
-            status |= xensiv_pasco2_set_measurement_rate(context, measurement_period);
-
-            meas_config = (xensiv_pasco2_measurement_config_t){
-                .b.op_mode = XENSIV_PASCO2_OP_MODE_CONTINUOUS,
-                .b.boc_cfg = XENSIV_PASCO2_BOC_CFG_AUTOMATIC
-            };
-            status |= xensiv_pasco2_set_measurement_config(context, meas_config);
+            /* During burst or adaptive sampling only store the new period, it
+             * is applied to the sensor when that mode ends.
+             */
+            cy_rslt_t status = CY_RSLT_SUCCESS;
+            if (!pasco2_burst_active && !pasco2_adaptive_enabled)
+            {
+                status = pasco2_set_measurement_rate(context, measurement_period);
+            }
 
             if (status == CY_RSLT_SUCCESS)
             {
                 pasco2_process_delay_s = measurement_period;
+                xTaskNotify(pasco2_task_handle, PASCO2_NOTIFY_PERIOD_CHANGED, eSetBits);
                 snprintf(publisher_q_data.data,
                         sizeof(publisher_q_data.data),
                         "Config => %.*s: %.*s",
@@ -118,6 +149,53 @@ static cy_rslt_t json_parser_cb(cy_JSON_object_t *json_object, void *arg)
             }
         }
     }
+    else if (json_key_equals(json_object, "pasco2_adaptive"))
+    {
+        pasco2_adaptive_enabled = (atoi(json_value) != 0);
+        xTaskNotify(pasco2_task_handle, PASCO2_NOTIFY_ADAPTIVE_CHANGED, eSetBits);
+        snprintf(publisher_q_data.data, sizeof(publisher_q_data.data),
+                 "Config => pasco2_adaptive: %d", pasco2_adaptive_enabled ? 1 : 0);
+    }
+    else if (json_key_equals(json_object, "pasco2_read_now"))
+    {
+        /* The value is ignored, the measurement is published as soon as ready */
+        xTaskNotify(pasco2_task_handle, PASCO2_NOTIFY_READ_NOW, eSetBits);
+        snprintf(publisher_q_data.data, sizeof(publisher_q_data.data),
+                 "Config => pasco2_read_now: accepted");
+    }
+    else if (json_key_equals(json_object, "pasco2_burst"))
+    {
+        const uint32_t burst_duration = atoi(json_value);
+        if ((burst_duration < PASCO2_BURST_DURATION_MIN_S) || (burst_duration > PASCO2_BURST_DURATION_MAX_S))
+        {
+            snprintf(publisher_q_data.data, sizeof(publisher_q_data.data),
+                     "pasco2_burst error, Valid range is [%u-%u]",
+                     PASCO2_BURST_DURATION_MIN_S, PASCO2_BURST_DURATION_MAX_S);
+        }
+        else
+        {
+            pasco2_burst_duration_s = burst_duration;
+            xTaskNotify(pasco2_task_handle, PASCO2_NOTIFY_BURST_START, eSetBits);
+            snprintf(publisher_q_data.data,
+                     sizeof(publisher_q_data.data),
+                     "Config => pasco2_burst: %u",
+                     (unsigned int)burst_duration);
+        }
+    }
+    else if (json_key_equals(json_object, "pasco2_trace_dump"))
+    {
+        /* The value is ignored. The trace is printed on the serial terminal,
+         * it is too large for an MQTT message.
+         */
+#if (SENSOR_TRACE_RECORD_ENABLED != 0)
+        snprintf(publisher_q_data.data, sizeof(publisher_q_data.data),
+                 "Config => pasco2_trace_dump: %u records",
+                 (unsigned int)sensor_trace_dump());
+#else
+        snprintf(publisher_q_data.data, sizeof(publisher_q_data.data),
+                 "pasco2_trace_dump error, recording is disabled");
+#endif
+    }
     else
     {
         /* Invalid input json key */
@@ -129,8 +207,8 @@ static cy_rslt_t json_parser_cb(cy_JSON_object_t *json_object, void *arg)
                  json_object->object_string);
     }
 
-    /* Send message back to publish queue. */
-    xQueueSendToBack(publisher_task_q, &publisher_q_data, 0);
+    /* Send the reply to the publish queue. */
+    (void)publisher_post(&publisher_q_data);
 
     return bad_entry ? CY_RSLT_JSON_GENERIC_ERROR : CY_RSLT_SUCCESS;
 }
@@ -150,35 +228,127 @@ static cy_rslt_t json_parser_cb(cy_JSON_object_t *json_object, void *arg)
  ******************************************************************************/
 void pasco2_config_task(void *pvParameters)
 {
-    cy_rslt_t result;
-
     /* To avoid compiler warnings */
     (void)pvParameters;
 
-    /* Register JSON parser to parse input configuration JSON string */
-    cy_JSON_parser_register_callback(json_parser_cb, (void *)&xensiv_pasco2);
+    pasco2_config_init();
 
     while (true)
     {
         /* Block till a notification is received from the subscriber task. */
         ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
 
-        /* Get mutex to block any other json parse jobs */
-        if (xSemaphoreTake(sem_sub_payload, portMAX_DELAY) == pdTRUE)
+        pasco2_config_handle();
+    }
+}
+
+/*******************************************************************************
+ * Function Name: pasco2_config_init
+ *******************************************************************************
+ * Summary:
+ *   Registers the JSON parser callback. In the APP_EVENT_LOOP_ENABLED build,
+ *   also creates the queue of the configuration requests.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void pasco2_config_init(void)
+{
+    /* Register JSON parser to parse input configuration JSON string */
+    cy_JSON_parser_register_callback(json_parser_cb, (void *)&xensiv_pasco2);
+
+#if (APP_EVENT_LOOP_ENABLED != 0)
+    pasco2_config_q = APP_QUEUE_CREATE(pasco2_config_q, PASCO2_CONFIG_QUEUE_LENGTH, sizeof(uint8_t));
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: pasco2_config_request
+ *******************************************************************************
+ * Summary:
+ *   Requests the parsing of the configuration in 'sub_msg_payload'. Requests
+ *   made before the previous one was handled are merged.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void pasco2_config_request(void)
+{
+#if (APP_EVENT_LOOP_ENABLED != 0)
+    const uint8_t request = 0;
+
+    if (pasco2_config_q != NULL)
+    {
+        xQueueOverwrite(pasco2_config_q, &request);
+    }
+#else
+    if (pasco2_config_task_handle != NULL)
+    {
+        xTaskNotifyGive(pasco2_config_task_handle);
+    }
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: pasco2_config_handle
+ *******************************************************************************
+ * Summary:
+ *   Parses the configuration in 'sub_msg_payload' and applies it to the
+ *   sensor. Called for each request by the configuration task, or by the
+ *   event loop task in the APP_EVENT_LOOP_ENABLED build.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void pasco2_config_handle(void)
+{
+    cy_rslt_t result;
+
+#if (APP_EVENT_LOOP_ENABLED != 0)
+    uint8_t request;
+
+    /* Consume the request that woke up the event loop */
+    (void)xQueueReceive(pasco2_config_q, &request, 0);
+#endif
+
+    /* The sensor task creates its mutex when it starts */
+    if (sem_pasco2_context == NULL)
+    {
+        printf("pasco2_config_task: sensor not ready, configuration ignored\n");
+        return;
+    }
+
+    /* Copy the configuration, so that the MQTT callback can store the next
+     * one while this one waits for the sensor.
+     */
+    if (xSemaphoreTake(sem_sub_payload, portMAX_DELAY) == pdTRUE)
+    {
+        memcpy(config_payload, sub_msg_payload, sizeof(config_payload));
+        xSemaphoreGive(sem_sub_payload);
+    }
+    config_payload[sizeof(config_payload) - 1u] = '\0';
+
+    printf("  Subscriber: Incoming configuration: %s\n\n", config_payload);
+
+    /* Get mutex to block mtb_radar_sensing_process in radar task */
+    if (xSemaphoreTake(sem_pasco2_context, portMAX_DELAY) == pdTRUE)
+    {
+        printf("parse config ... \n");
+        result = cy_JSON_parser(config_payload, strlen(config_payload));
+        if (result != CY_RSLT_SUCCESS)
         {
-            /* Get mutex to block mtb_radar_sensing_process in radar task */
-            if (xSemaphoreTake(sem_pasco2_context, portMAX_DELAY) == pdTRUE)
-            {
-                printf("parse config ... \n");
-                result = cy_JSON_parser(sub_msg_payload, strlen(sub_msg_payload));
-                if (result != CY_RSLT_SUCCESS)
-                {
-                    printf("pasco2_config_task: json parser error!\n");
-                }
-                xSemaphoreGive(sem_pasco2_context);
-            }
-            xSemaphoreGive(sem_sub_payload);
+            printf("pasco2_config_task: json parser error!\n");
         }
+        xSemaphoreGive(sem_pasco2_context);
     }
 }
 
@@ -28,23 +28,38 @@
 #pragma once
 
 #include "FreeRTOS.h"
+#include "queue.h"
 #include "task.h"
+#include "stack_size_config.h"
+
+#include "app_event_loop.h"
 
 /*******************************************************************************
  * Macros
  ******************************************************************************/
 #define PASCO2_CONFIG_TASK_NAME       "PASCO2 CONFIG TASK"
 #define PASCO2_CONFIG_TASK_PRIORITY   (5)
+#ifndef PASCO2_CONFIG_TASK_STACK_SIZE
 #define PASCO2_CONFIG_TASK_STACK_SIZE (1024 * 2)
+#endif
+
+/* Pending configuration requests, later requests are merged */
+#define PASCO2_CONFIG_QUEUE_LENGTH    (1u)
 
 /*******************************************************************************
  * Global Variables
  *******************************************************************************/
 extern TaskHandle_t pasco2_config_task_handle;
+#if (APP_EVENT_LOOP_ENABLED != 0)
+extern QueueHandle_t pasco2_config_q;
+#endif
 
 /*******************************************************************************
  * Functions
  *******************************************************************************/
 void pasco2_config_task(void *pvParameters);
+void pasco2_config_init(void);
+void pasco2_config_request(void);
+void pasco2_config_handle(void);
 
 /* [] END OF FILE */
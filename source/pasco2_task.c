@@ -25,6 +25,7 @@
 
 /* Header file from system */
 #include <inttypes.h>
+#include <math.h>
 #include <stdio.h>
 
 /* Header file includes */
@@ -32,9 +33,19 @@
 #include "cyhal.h"
 
 /* Header file for local task */
+#include "app_alloc.h"
+#include "co2_analytics.h"
+#include "co2_synthetic.h"
+#include "fault_injection.h"
+#include "pasco2_adaptive.h"
 #include "pasco2_config_task.h"
 #include "pasco2_task.h"
+#include "payload_format.h"
+#include "prng.h"
 #include "publisher_task.h"
+#include "sample_schedule.h"
+#include "sensor_trace.h"
+#include "time_sync.h"
 #include "xensiv_dps3xx_mtb.h"
 
 /* Output pin for sensor PSEL line */
@@ -59,24 +70,94 @@
 /* I2C bus frequency */
 #define I2C_MASTER_FREQUENCY (100000U)
 
-#define DEFAULT_PRESSURE_VALUE (1015.0F)
+/* Default pressure in Pa * 10 used when no DPS3xx sensor is available */
+#define DEFAULT_PRESSURE_PA_X10 (1015000U)
+
+/* Conversion factors of the fixed-point pressure and temperature */
+#define PRESSURE_HPA_TO_PA_X10  (1000U)
+#define PRESSURE_HPA_X10_TO_PA_X10 (100U)
+#define TEMPERATURE_C_TO_C_X100 (100.0f)
 
 /* Delay time after hardware initialization */
 #define PASCO2_INITIALIZATION_DELAY (2000)
 
+/* Polling interval and timeout while waiting for a single-shot measurement */
+#define PASCO2_SINGLE_SHOT_POLL_MS    (100U)
+#define PASCO2_SINGLE_SHOT_TIMEOUT_MS (3000U)
+
 /*******************************************************************************
  * Global Variables
  ******************************************************************************/
 TaskHandle_t pasco2_task_handle = NULL;
 /* Semaphore to protect PASCO2 driver context */
 SemaphoreHandle_t sem_pasco2_context = NULL;
+APP_MUTEX_MEMORY(sem_pasco2_context);
+#if (APP_EVENT_LOOP_ENABLED == 0)
+APP_TASK_MEMORY(pasco2_config_task, PASCO2_CONFIG_TASK_STACK_SIZE);
+#endif
 xensiv_pasco2_t xensiv_pasco2;
 /* Delay time after each call to PAS CO2 Process.Default is 10 seconds */
 uint32_t pasco2_process_delay_s = 10;
+/* Duration of the burst sampling requested over MQTT */
+uint32_t pasco2_burst_duration_s = 0;
+/* True while burst sampling overrides 'pasco2_process_delay_s' */
+bool pasco2_burst_active = false;
+/* True while the adaptive scheduler selects the measurement period */
+bool pasco2_adaptive_enabled = PASCO2_ADAPTIVE_ENABLED_DEFAULT;
 
 /*******************************************************************************
  * Local Variables
  ******************************************************************************/
+static xensiv_dps3xx_t xensiv_dps3xx;
+static bool use_dps = true;
+/* State of the adaptive scheduler */
+static pasco2_adaptive_t pasco2_adaptive;
+/* State of the anomaly detectors */
+static co2_analytics_t co2_analytics;
+/* Routine samples skipped since the last published telemetry */
+static uint32_t telemetry_skip_count = 0;
+/* Random sequence for the publish jitter */
+static prng_t jitter_prng;
+
+/* Absolute release times of the continuous samples */
+static sample_schedule_t sample_schedule;
+
+/* Sequence number of the last telemetry or alert message. The backend drops
+ * a redelivered message whose sequence number it already received.
+ */
+static uint32_t publish_seq = 0;
+/* Last value of the PAS CO2 status register */
+static uint8_t last_sensor_status = 0;
+#if (PASCO2_SENSOR_SOURCE == PASCO2_SENSOR_SOURCE_SYNTHETIC)
+/* State of the synthetic CO2 source and time of its last sample */
+static co2_synthetic_t co2_synthetic;
+static uint64_t synthetic_last_ms = 0;
+#elif (PASCO2_SENSOR_SOURCE == PASCO2_SENSOR_SOURCE_REPLAY)
+/* Recorded time of the last replayed sample */
+static uint64_t replay_now_ms = 0;
+#endif
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+static uint32_t pasco2_active_period_s(void);
+static uint32_t pasco2_sample_period_ms(void);
+static void pasco2_schedule_report(void);
+static void pasco2_adaptive_sample(uint16_t ppm);
+static uint64_t pasco2_now_ms(void);
+static cy_rslt_t pasco2_sensor_read(uint16_t *ppm);
+#if (PASCO2_SENSOR_SOURCE != PASCO2_SENSOR_SOURCE_REPLAY)
+static uint32_t pasco2_read_pressure(int16_t *temperature_c_x100);
+static void pasco2_trace_read(uint16_t ppm, uint32_t pressure_pa_x10, int16_t temperature_c_x100, cy_rslt_t result);
+#endif
+#if (PASCO2_SENSOR_SOURCE == PASCO2_SENSOR_SOURCE_HW)
+static uint16_t pasco2_pressure_hpa(uint32_t pressure_pa_x10);
+#endif
+static void pasco2_check_status(uint8_t status);
+static cy_rslt_t pasco2_read_single_shot(uint16_t *ppm);
+static void pasco2_process_sample(uint16_t ppm, uint64_t timestamp_ms, bool force_publish);
+static void pasco2_publish_ppm(uint16_t ppm, uint64_t timestamp_ms);
+static void pasco2_print_read_error(cy_rslt_t result);
 
 /*******************************************************************************
  * Function Name: pasco2_task
@@ -98,9 +179,6 @@ void pasco2_task(void *pvParameters)
     /* To avoid compiler warnings */
     (void)pvParameters;
 
-    xensiv_dps3xx_t xensiv_dps3xx;
-    bool use_dps = true;
-
     /* I2C variables */
     cyhal_i2c_t cyhal_i2c;
 
@@ -156,6 +234,13 @@ void pasco2_task(void *pvParameters)
         use_dps = false;
     }
 
+#if (PASCO2_SENSOR_SOURCE == PASCO2_SENSOR_SOURCE_SYNTHETIC)
+    co2_synthetic_init(&co2_synthetic, prng_device_seed());
+    synthetic_last_ms = time_sync_get_mono_ms();
+    printf("Using synthetic CO2 source, seed 0x%08lx\n", (unsigned long)prng_device_seed());
+#elif (PASCO2_SENSOR_SOURCE == PASCO2_SENSOR_SOURCE_REPLAY)
+    printf("Using recorded CO2 trace, %u times faster than real time\n", (unsigned int)PASCO2_REPLAY_SPEEDUP);
+#else
     /* Initialize PAS CO2 sensor with default parameter values */
     result = xensiv_pasco2_mtb_init_i2c(&xensiv_pasco2, &cyhal_i2c);
     if (result != CY_RSLT_SUCCESS)
@@ -176,28 +261,32 @@ void pasco2_task(void *pvParameters)
         printf("PAS CO2 interrupt configuration error");
         CY_ASSERT(0);
     }
+#endif /* PASCO2_SENSOR_SOURCE */
     /* Initiate semaphore mutex to protect 'pasco2_context' */
-    sem_pasco2_context = xSemaphoreCreateMutex();
+    sem_pasco2_context = APP_MUTEX_CREATE(sem_pasco2_context);
     if (sem_pasco2_context == NULL)
     {
         printf(" 'sem_pasco2_context' semaphore creation failed... Task suspend\n\n");
         vTaskSuspend(NULL);
     }
 
+#if (APP_EVENT_LOOP_ENABLED == 0)
     /**
      * Create task for pasco2 sensor module configuration. Configuration parameters come from
      * Subscriber task. Subscribed topics are configured inside 'mqtt_client_config.c'.
+     * The event loop task handles the configuration in the APP_EVENT_LOOP_ENABLED build.
      */
-    if (pdPASS != xTaskCreate(pasco2_config_task,
-                              PASCO2_CONFIG_TASK_NAME,
-                              PASCO2_CONFIG_TASK_STACK_SIZE,
-                              NULL,
-                              PASCO2_CONFIG_TASK_PRIORITY,
-                              &pasco2_config_task_handle))
+    if (pdPASS != APP_TASK_CREATE(pasco2_config_task,
+                                  PASCO2_CONFIG_TASK_NAME,
+                                  PASCO2_CONFIG_TASK_STACK_SIZE,
+                                  NULL,
+                                  PASCO2_CONFIG_TASK_PRIORITY,
+                                  &pasco2_config_task_handle))
     {
         printf("Failed to create PASCO2 config task!\n");
         CY_ASSERT(0);
     }
+#endif /* APP_EVENT_LOOP_ENABLED */
 
     /* Stop LED blinking timer, turn on LED to indicate user that turn-on phase is over and entering ready state */
     result = cyhal_timer_stop(&led_blink_timer);
@@ -209,34 +298,140 @@ void pasco2_task(void *pvParameters)
     /* Turn on status LED on PAS CO2 Wing Board to indicate normal operation */
     cyhal_gpio_write(MTB_PASCO2_LED_OK, MTB_PASCO_LED_STATE_ON);
 
-    publisher_data_t publisher_q_data;
-    publisher_q_data.cmd = PUBLISH_MQTT_MSG;
+    TickType_t burst_end_tick = 0;
+    uint32_t notify_bits;
+
+    co2_analytics_init(&co2_analytics);
+    prng_init(&jitter_prng, prng_device_seed());
+
+    /* Adaptive sampling enabled by default starts from the configured period */
+    if (pasco2_adaptive_enabled && (xSemaphoreTake(sem_pasco2_context, portMAX_DELAY) == pdTRUE))
+    {
+        pasco2_adaptive_init(&pasco2_adaptive, (uint16_t)pasco2_process_delay_s, pasco2_now_ms());
+        if (pasco2_set_measurement_rate(&xensiv_pasco2, (uint16_t)pasco2_active_period_s()) != CY_RSLT_SUCCESS)
+        {
+            printf("CO2 adaptive sampling start failed\n");
+        }
+        xSemaphoreGive(sem_pasco2_context);
+    }
+
+    sample_schedule_init(&sample_schedule, pasco2_sample_period_ms(), time_sync_get_mono_ms());
+#if (PASCO2_UTC_ALIGNED_SAMPLING != 0) && (PASCO2_SENSOR_SOURCE != PASCO2_SENSOR_SOURCE_REPLAY)
+    /* The phase spreads the publishes of a fleet within the UTC buckets */
+    sample_schedule_align(&sample_schedule, true,
+                          (PASCO2_ALIGN_PHASE_SPREAD_MS > 0U) ? (prng_device_seed() % PASCO2_ALIGN_PHASE_SPREAD_MS) : 0U);
+#endif
 
     for (;;)
     {
         uint16_t ppm = 0;
+        uint64_t timestamp_ms = 0;
+        /* The random jitter is not used on the UTC grid, the phase replaces it */
+        const uint32_t offset_ms = sample_schedule.aligned ? 0U : prng_range(&jitter_prng, 0U, PASCO2_PUBLISH_JITTER_MS);
+        const uint32_t delay_ms = sample_schedule_delay_ms(&sample_schedule, pasco2_sample_period_ms(), offset_ms,
+                                                           time_sync_get_mono_ms(), time_sync_get_utc_ms());
 
-        if (xSemaphoreTake(sem_pasco2_context, portMAX_DELAY) == pdTRUE)
+        /* Sleep until the next release time, unless another task requests an
+         * immediate action through a task notification.
+         */
+        if (xTaskNotifyWait(0, UINT32_MAX, &notify_bits, pdMS_TO_TICKS(delay_ms)) == pdTRUE)
         {
-            /* Read pressure value from sensor */
-        float32_t pressure;
-        if (use_dps == true)
-        {
-            float32_t temperature;
-            /* Read pressure value from sensor */
-            result = xensiv_dps3xx_read(&xensiv_dps3xx, &pressure, &temperature);
-            if (result != CY_RSLT_SUCCESS)
+            /* Set when the sensor restarted its measurement period */
+            bool rearmed = false;
+
+            if (xSemaphoreTake(sem_pasco2_context, portMAX_DELAY) == pdTRUE)
+            {
+                if (notify_bits & PASCO2_NOTIFY_BURST_START)
+                {
+                    result = pasco2_set_measurement_rate(&xensiv_pasco2, XENSIV_PASCO2_MEAS_RATE_MIN);
+                    if (result == CY_RSLT_SUCCESS)
+                    {
+                        rearmed = true;
+                        pasco2_burst_active = true;
+                        burst_end_tick = xTaskGetTickCount() + pdMS_TO_TICKS(pasco2_burst_duration_s * 1000);
+                        printf("CO2 burst sampling started for %u s\n", (unsigned int)pasco2_burst_duration_s);
+                    }
+                    else
+                    {
+                        printf("CO2 burst sampling start failed\n");
+                    }
+                }
+
+                if ((notify_bits & PASCO2_NOTIFY_ADAPTIVE_CHANGED) && !pasco2_burst_active)
+                {
+                    if (pasco2_adaptive_enabled)
+                    {
+                        pasco2_adaptive_init(&pasco2_adaptive, (uint16_t)pasco2_process_delay_s, pasco2_now_ms());
+                    }
+                    if (pasco2_set_measurement_rate(&xensiv_pasco2, (uint16_t)pasco2_active_period_s()) != CY_RSLT_SUCCESS)
+                    {
+                        printf("CO2 adaptive sampling mode change failed\n");
+                    }
+                    rearmed = true;
+                }
+
+                if (notify_bits & PASCO2_NOTIFY_READ_NOW)
+                {
+                    /* The single shot restarts the continuous measurement */
+                    rearmed = true;
+                    result = pasco2_read_single_shot(&ppm);
+                    timestamp_ms = time_sync_get_utc_ms();
+                    if (result == CY_RSLT_SUCCESS)
+                    {
+                        pasco2_process_sample(ppm, timestamp_ms, true);
+                    }
+                    else
+                    {
+                        pasco2_print_read_error(result);
+                    }
+                }
+
+                xSemaphoreGive(sem_pasco2_context);
+            }
+
+            /* When the sensor restarted its measurement period, wait for a
+             * full period before reading the next continuous result. A plain
+             * period change keeps the phase of the grid, the next delay
+             * applies it from the last release.
+             */
+            if (rearmed)
             {
-                printf("Error while reading from pressure sensor\r\n");
-                CY_ASSERT(0);
+                sample_schedule_restart(&sample_schedule, pasco2_sample_period_ms(), time_sync_get_mono_ms());
             }
+            continue;
         }
-        else
+
+        sample_schedule_release(&sample_schedule, time_sync_get_mono_ms(), time_sync_get_utc_ms());
+        if ((sample_schedule.sample_count % PASCO2_SCHEDULE_REPORT_SAMPLES) == 0U)
         {
-            pressure = DEFAULT_PRESSURE_VALUE;
+            pasco2_schedule_report();
         }
+
+        if (xSemaphoreTake(sem_pasco2_context, portMAX_DELAY) == pdTRUE)
+        {
             /* Read CO2 value from sensor */
-            result = xensiv_pasco2_mtb_read(&xensiv_pasco2, (uint16_t)pressure, &ppm);
+            result = pasco2_sensor_read(&ppm);
+            timestamp_ms = time_sync_get_utc_ms();
+
+            if ((result == CY_RSLT_SUCCESS) && pasco2_adaptive_enabled && !pasco2_burst_active)
+            {
+                pasco2_adaptive_sample(ppm);
+            }
+
+            /* Revert to the configured measurement period once the burst ends */
+            if (pasco2_burst_active && ((int32_t)(xTaskGetTickCount() - burst_end_tick) >= 0))
+            {
+                pasco2_burst_active = false;
+                if (pasco2_adaptive_enabled)
+                {
+                    pasco2_adaptive_init(&pasco2_adaptive, pasco2_adaptive.period_s, pasco2_now_ms());
+                }
+                if (pasco2_set_measurement_rate(&xensiv_pasco2, (uint16_t)pasco2_active_period_s()) != CY_RSLT_SUCCESS)
+                {
+                    printf("CO2 burst sampling stop failed\n");
+                }
+                printf("CO2 burst sampling finished\n");
+            }
 
             xSemaphoreGive(sem_pasco2_context);
         }
@@ -246,61 +441,607 @@ void pasco2_task(void *pvParameters)
             /* Turn-off warning LED*/
             cyhal_gpio_write(MTB_PASCO2_LED_WARNING, MTB_PASCO_LED_STATE_OFF);
 
-            memset(publisher_q_data.data, 0, sizeof(publisher_q_data.data));
-            snprintf(publisher_q_data.data, sizeof(publisher_q_data.data), "{\"CO2 PPM Level\": \"%d\"}", ppm);
-            /**
-             * Send message back to publish queue. If queue is full, 'local_pub_msg' will be dropped.
-             * So no result checking. */
-            xQueueSendToBack(publisher_task_q, &publisher_q_data, 0);
+            pasco2_process_sample(ppm, timestamp_ms, false);
         }
         else
         {
-            if (CY_RSLT_GET_CODE(result) == XENSIV_PASCO2_READ_NRDY)
-            {
-                /* New value is not available yet */
-                printf("CO2 PPM value is not ready\n");
-            }
-            else if (CY_RSLT_GET_CODE(result) == XENSIV_PASCO2_ERR_COMM)
-            {
-                /* I2C communication error */
-                printf("I2C communication error\n");
-            }
-            else
-            {
-                printf("Unexpected error\n");
-            }
+            pasco2_print_read_error(result);
         }
 
+#if (PASCO2_SENSOR_SOURCE == PASCO2_SENSOR_SOURCE_HW)
         xensiv_pasco2_status_t sensor_status;
         if (xensiv_pasco2_get_status(&xensiv_pasco2, &sensor_status) == CY_RSLT_SUCCESS)
         {
-            bool error_status = false;
-            if (sensor_status.u & XENSIV_PASCO2_REG_SENS_STS_ICCER_MSK)
-            {
-                /* Sensor detected communication problem with MCU */
-                printf("CO2 Sensor Communication Error\n");
-                error_status = true;
-            }
+            last_sensor_status = sensor_status.u;
+            pasco2_check_status(last_sensor_status);
+        }
+#else
+        /* Replayed status, always zero for the synthetic source */
+        pasco2_check_status(last_sensor_status);
+#endif /* PASCO2_SENSOR_SOURCE */
+    }
+}
 
-            if (sensor_status.u & XENSIV_PASCO2_REG_SENS_STS_ORVS_MSK)
-            {
-                /* Sensor detected over-voltage problem */
-                printf("CO2 Sensor Over-Voltage Error\n");
-                error_status = true;
-            }
+/*******************************************************************************
+ * Function Name: pasco2_set_measurement_rate
+ *******************************************************************************
+ * Summary:
+ *   Puts the sensor in idle mode, sets the new measurement rate and restarts
+ *   the continuous measurement. The caller must hold 'sem_pasco2_context'.
+ *   The synthetic and replay sources have no rate, their samples follow the
+ *   read times.
+ *
+ * Parameters:
+ *   context: PAS CO2 driver context
+ *   period_s: measurement period in seconds
+ *
+ * Return:
+ *   cy_rslt_t: CY_RSLT_SUCCESS on success, else an error code
+ ******************************************************************************/
+cy_rslt_t pasco2_set_measurement_rate(xensiv_pasco2_t *context, uint16_t period_s)
+{
+#if (PASCO2_SENSOR_SOURCE != PASCO2_SENSOR_SOURCE_HW)
+    (void)context;
+    (void)period_s;
+    return CY_RSLT_SUCCESS;
+#else
+    xensiv_pasco2_measurement_config_t meas_config = {
+        .b.op_mode = XENSIV_PASCO2_OP_MODE_IDLE,
+        .b.boc_cfg = XENSIV_PASCO2_BOC_CFG_AUTOMATIC
+    };
+    int32_t status = xensiv_pasco2_set_measurement_config(context, meas_config);
+
+    status |= xensiv_pasco2_set_measurement_rate(context, period_s);
+
+    meas_config = (xensiv_pasco2_measurement_config_t){
+        .b.op_mode = XENSIV_PASCO2_OP_MODE_CONTINUOUS,
+        .b.boc_cfg = XENSIV_PASCO2_BOC_CFG_AUTOMATIC
+    };
+    status |= xensiv_pasco2_set_measurement_config(context, meas_config);
+
+    return (status == XENSIV_PASCO2_OK) ? CY_RSLT_SUCCESS : (cy_rslt_t)status;
+#endif /* PASCO2_SENSOR_SOURCE */
+}
+
+/*******************************************************************************
+ * Function Name: pasco2_sample_period_ms
+ *******************************************************************************
+ * Summary:
+ *   Returns the period of the continuous samples. The replay source runs
+ *   PASCO2_REPLAY_SPEEDUP times faster than the recorded time.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   uint32_t: sample period in milliseconds
+ ******************************************************************************/
+static uint32_t pasco2_sample_period_ms(void)
+{
+    uint32_t period_ms = pasco2_active_period_s() * 1000U;
+#if (PASCO2_SENSOR_SOURCE == PASCO2_SENSOR_SOURCE_REPLAY)
+    period_ms /= PASCO2_REPLAY_SPEEDUP;
+#endif
+    return period_ms;
+}
+
+/*******************************************************************************
+ * Function Name: pasco2_schedule_report
+ *******************************************************************************
+ * Summary:
+ *   Prints the sample scheduler metrics and publishes them on the
+ *   diagnostics topic: the samples released, the grid points skipped after
+ *   overruns, and the average and largest delay of a release as
+ *   {"sched_n":n,"overrun":o,"jitter_ms":[avg,max]}. On the UTC grid, the
+ *   average and largest alignment error and the phase of the device follow
+ *   as {"align_n":n,"align_ms":[avg,max],"phase_ms":p}.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void pasco2_schedule_report(void)
+{
+    const sample_schedule_t *schedule = &sample_schedule;
+    const uint32_t jitter_avg_ms = (uint32_t)(schedule->jitter_sum_ms / schedule->sample_count);
+    publisher_data_t publisher_q_data;
+
+    printf("CO2 schedule: %lu samples, %lu overruns, jitter avg %lu ms, max %lu ms\n",
+           (unsigned long)schedule->sample_count, (unsigned long)schedule->overrun_count,
+           (unsigned long)jitter_avg_ms, (unsigned long)schedule->jitter_max_ms);
+
+    publisher_q_data.cmd = PUBLISH_MQTT_DIAG;
+    publisher_q_data.seq = 0;
+    snprintf(publisher_q_data.data, sizeof(publisher_q_data.data),
+             "{\"sched_n\":%lu,\"overrun\":%lu,\"jitter_ms\":[%lu,%lu]}",
+             (unsigned long)schedule->sample_count, (unsigned long)schedule->overrun_count,
+             (unsigned long)jitter_avg_ms, (unsigned long)schedule->jitter_max_ms);
+    (void)publisher_post(&publisher_q_data);
+
+    if (schedule->align_count > 0U)
+    {
+        const uint32_t align_avg_ms = (uint32_t)(schedule->align_sum_ms / schedule->align_count);
+
+        printf("CO2 schedule: %lu samples on the UTC grid, alignment error avg %lu ms, max %lu ms\n",
+               (unsigned long)schedule->align_count, (unsigned long)align_avg_ms,
+               (unsigned long)schedule->align_max_ms);
+
+        snprintf(publisher_q_data.data, sizeof(publisher_q_data.data),
+                 "{\"align_n\":%lu,\"align_ms\":[%lu,%lu],\"phase_ms\":%lu}",
+                 (unsigned long)schedule->align_count, (unsigned long)align_avg_ms,
+                 (unsigned long)schedule->align_max_ms,
+                 (unsigned long)(schedule->phase_ms % schedule->period_ms));
+        (void)publisher_post(&publisher_q_data);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: pasco2_active_period_s
+ *******************************************************************************
+ * Summary:
+ *   Returns the measurement period currently in effect. Burst sampling takes
+ *   precedence over adaptive sampling, which takes precedence over the
+ *   configured period.
+ *
+ * Parameters:
+ *   void
+ *
+ * Return:
+ *   uint32_t: measurement period in seconds
+ ******************************************************************************/
+static uint32_t pasco2_active_period_s(void)
+{
+    if (pasco2_burst_active)
+    {
+        return XENSIV_PASCO2_MEAS_RATE_MIN;
+    }
+
+    if (pasco2_adaptive_enabled)
+    {
+        return pasco2_adaptive.period_s;
+    }
+
+    return pasco2_process_delay_s;
+}
+
+/*******************************************************************************
+ * Function Name: pasco2_adaptive_sample
+ *******************************************************************************
+ * Summary:
+ *   Feeds a CO2 value into the adaptive scheduler and applies the new
+ *   measurement period to the sensor when it changes. Every change is
+ *   published on the diagnostics topic together with the sample count and
+ *   the number of samples the fixed period would have taken. The caller must hold
+ *   'sem_pasco2_context'.
+ *
+ * Parameters:
+ *   ppm: CO2 value read from the sensor
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void pasco2_adaptive_sample(uint16_t ppm)
+{
+    const uint64_t now_ms = pasco2_now_ms();
+    const uint16_t old_period_s = pasco2_adaptive.period_s;
+    const uint16_t new_period_s = pasco2_adaptive_update(&pasco2_adaptive, ppm, now_ms);
+
+    if (new_period_s != old_period_s)
+    {
+        if (pasco2_set_measurement_rate(&xensiv_pasco2, new_period_s) != CY_RSLT_SUCCESS)
+        {
+            printf("CO2 adaptive measurement period change failed\n");
+            return;
+        }
+
+        publisher_data_t publisher_q_data;
+        publisher_q_data.cmd = PUBLISH_MQTT_DIAG;
+        publisher_q_data.seq = 0;
+        snprintf(publisher_q_data.data, sizeof(publisher_q_data.data),
+                 "{\"period\": %u, \"samples\": %lu, \"fixed\": %lu}",
+                 (unsigned int)new_period_s,
+                 (unsigned long)pasco2_adaptive.sample_count,
+                 (unsigned long)pasco2_adaptive_fixed_samples(&pasco2_adaptive, pasco2_process_delay_s, now_ms));
+        (void)publisher_post(&publisher_q_data);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: pasco2_now_ms
+ *******************************************************************************
+ * Summary:
+ *   Returns the monotonic time used by the detectors and the adaptive
+ *   scheduler. During replay this is the recorded time of the last sample.
+ *
+ * Parameters:
+ *   void
+ *
+ * Return:
+ *   uint64_t: monotonic time in milliseconds
+ ******************************************************************************/
+static uint64_t pasco2_now_ms(void)
+{
+#if (PASCO2_SENSOR_SOURCE == PASCO2_SENSOR_SOURCE_REPLAY)
+    return replay_now_ms;
+#else
+    return time_sync_get_mono_ms();
+#endif
+}
+
+#if (PASCO2_SENSOR_SOURCE != PASCO2_SENSOR_SOURCE_REPLAY)
+/*******************************************************************************
+ * Function Name: pasco2_read_pressure
+ *******************************************************************************
+ * Summary:
+ *   Reads the pressure used for CO2 compensation from the DPS3xx sensor, or
+ *   returns a default value when no pressure sensor is available. The DPS3xx
+ *   driver compensates the raw values in floating point and has no integer
+ *   interface, so the float math of the driver runs for each sample anyway.
+ *   Its results are rounded to fixed point once here, and all further
+ *   processing is integer only.
+ *
+ * Parameters:
+ *   temperature_c_x100: DPS3xx temperature in degree Celsius * 100, or
+ *                       SENSOR_TRACE_TEMPERATURE_UNKNOWN
+ *
+ * Return:
+ *   uint32_t: pressure in Pa * 10
+ ******************************************************************************/
+static uint32_t pasco2_read_pressure(int16_t *temperature_c_x100)
+{
+    uint32_t pressure_pa_x10 = DEFAULT_PRESSURE_PA_X10;
+
+    *temperature_c_x100 = SENSOR_TRACE_TEMPERATURE_UNKNOWN;
+
+    if (use_dps == true)
+    {
+        float32_t pressure;
+        float32_t temperature;
+        /* Read pressure value from sensor */
+        if (xensiv_dps3xx_read(&xensiv_dps3xx, &pressure, &temperature) != CY_RSLT_SUCCESS)
+        {
+            printf("Error while reading from pressure sensor\r\n");
+            CY_ASSERT(0);
+        }
+        pressure_pa_x10 = (uint32_t)lroundf(pressure * (float32_t)PRESSURE_HPA_TO_PA_X10);
+        *temperature_c_x100 = (int16_t)lroundf(temperature * TEMPERATURE_C_TO_C_X100);
+    }
+
+    return pressure_pa_x10;
+}
+
+#endif /* PASCO2_SENSOR_SOURCE */
+
+#if (PASCO2_SENSOR_SOURCE == PASCO2_SENSOR_SOURCE_HW)
+/*******************************************************************************
+ * Function Name: pasco2_pressure_hpa
+ *******************************************************************************
+ * Summary:
+ *   Converts the fixed-point pressure to the rounded hPa value expected by
+ *   the PAS CO2 pressure compensation.
+ *
+ * Parameters:
+ *   pressure_pa_x10: pressure in Pa * 10
+ *
+ * Return:
+ *   uint16_t: pressure in hPa
+ ******************************************************************************/
+static uint16_t pasco2_pressure_hpa(uint32_t pressure_pa_x10)
+{
+    return (uint16_t)((pressure_pa_x10 + (PRESSURE_HPA_TO_PA_X10 / 2U)) / PRESSURE_HPA_TO_PA_X10);
+}
+
+#endif /* PASCO2_SENSOR_SOURCE */
+
+/*******************************************************************************
+ * Function Name: pasco2_sensor_read
+ *******************************************************************************
+ * Summary:
+ *   Reads the CO2 value from the configured source and records the read in
+ *   the sensor trace. The synthetic source advances its room model by the
+ *   time since its previous sample, the replay source returns the next
+ *   recorded read including its result and sensor status.
+ *
+ * Parameters:
+ *   ppm: CO2 value read from the source
+ *
+ * Return:
+ *   cy_rslt_t: CY_RSLT_SUCCESS on success, else an error code
+ ******************************************************************************/
+static cy_rslt_t pasco2_sensor_read(uint16_t *ppm)
+{
+    cy_rslt_t result;
+
+#if (PASCO2_SENSOR_SOURCE == PASCO2_SENSOR_SOURCE_REPLAY)
+    sensor_trace_record_t record;
+
+    replay_now_ms = sensor_trace_replay_next(&record);
+    *ppm = record.ppm;
+    last_sensor_status = record.status;
+    result = (cy_rslt_t)record.result;
+#else
+    int16_t temperature_c_x100;
+    const uint32_t pressure_pa_x10 = pasco2_read_pressure(&temperature_c_x100);
+
+#if (PASCO2_SENSOR_SOURCE == PASCO2_SENSOR_SOURCE_SYNTHETIC)
+    const uint64_t now_ms = time_sync_get_mono_ms();
+
+    *ppm = co2_synthetic_next(&co2_synthetic, (uint32_t)((now_ms - synthetic_last_ms) / 1000U));
+    /* Keep the remainder, so that short periods still advance the model */
+    synthetic_last_ms = now_ms - ((now_ms - synthetic_last_ms) % 1000U);
+    result = CY_RSLT_SUCCESS;
+#else
+    result = xensiv_pasco2_mtb_read(&xensiv_pasco2, pasco2_pressure_hpa(pressure_pa_x10), ppm);
+#endif
 
-            if (sensor_status.u & XENSIV_PASCO2_REG_SENS_STS_ORTMP_MSK)
+    pasco2_trace_read(*ppm, pressure_pa_x10, temperature_c_x100, result);
+#endif /* PASCO2_SENSOR_SOURCE */
+
+    return result;
+}
+
+#if (PASCO2_SENSOR_SOURCE != PASCO2_SENSOR_SOURCE_REPLAY)
+/*******************************************************************************
+ * Function Name: pasco2_trace_read
+ *******************************************************************************
+ * Summary:
+ *   Records a sensor read in the sensor trace, if recording is enabled.
+ *
+ * Parameters:
+ *   ppm: CO2 value read from the sensor
+ *   pressure_pa_x10: pressure used for the CO2 compensation in Pa * 10
+ *   temperature_c_x100: DPS3xx temperature in degree Celsius * 100
+ *   result: result of the CO2 read
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void pasco2_trace_read(uint16_t ppm, uint32_t pressure_pa_x10, int16_t temperature_c_x100, cy_rslt_t result)
+{
+#if (SENSOR_TRACE_RECORD_ENABLED != 0)
+    const sensor_trace_record_t record = {
+        .time_ms = (uint32_t)time_sync_get_mono_ms(),
+        .ppm = ppm,
+        .pressure_hpa_x10 = (uint16_t)(pressure_pa_x10 / PRESSURE_HPA_X10_TO_PA_X10),
+        .temperature_c_x100 = temperature_c_x100,
+        .status = last_sensor_status,
+        .result = (uint8_t)CY_RSLT_GET_CODE(result)
+    };
+
+    sensor_trace_record(&record);
+#else
+    (void)ppm;
+    (void)pressure_pa_x10;
+    (void)temperature_c_x100;
+    (void)result;
+#endif
+}
+#endif /* PASCO2_SENSOR_SOURCE */
+
+/*******************************************************************************
+ * Function Name: pasco2_read_single_shot
+ *******************************************************************************
+ * Summary:
+ *   Triggers a single-shot measurement, polls until the result is ready and
+ *   then restarts the continuous measurement with the active period. The
+ *   caller must hold 'sem_pasco2_context'.
+ *
+ * Parameters:
+ *   ppm: CO2 value read from the sensor
+ *
+ * Return:
+ *   cy_rslt_t: CY_RSLT_SUCCESS on success, else an error code
+ ******************************************************************************/
+static cy_rslt_t pasco2_read_single_shot(uint16_t *ppm)
+{
+#if (PASCO2_SENSOR_SOURCE != PASCO2_SENSOR_SOURCE_HW)
+    return pasco2_sensor_read(ppm);
+#else
+    cy_rslt_t result;
+    xensiv_pasco2_measurement_config_t meas_config = {
+        .b.op_mode = XENSIV_PASCO2_OP_MODE_IDLE,
+        .b.boc_cfg = XENSIV_PASCO2_BOC_CFG_AUTOMATIC
+    };
+
+    result = (cy_rslt_t)xensiv_pasco2_set_measurement_config(&xensiv_pasco2, meas_config);
+    if (result == CY_RSLT_SUCCESS)
+    {
+        result = (cy_rslt_t)xensiv_pasco2_start_single_mode(&xensiv_pasco2);
+    }
+
+    if (result == CY_RSLT_SUCCESS)
+    {
+        int16_t temperature_c_x100;
+        const uint32_t pressure_pa_x10 = pasco2_read_pressure(&temperature_c_x100);
+
+        for (uint32_t waited_ms = 0; waited_ms < PASCO2_SINGLE_SHOT_TIMEOUT_MS; waited_ms += PASCO2_SINGLE_SHOT_POLL_MS)
+        {
+            vTaskDelay(pdMS_TO_TICKS(PASCO2_SINGLE_SHOT_POLL_MS));
+            result = xensiv_pasco2_mtb_read(&xensiv_pasco2, pasco2_pressure_hpa(pressure_pa_x10), ppm);
+            if (CY_RSLT_GET_CODE(result) != XENSIV_PASCO2_READ_NRDY)
             {
-                /* Sensor detected temperature problem */
-                printf("CO2 Sensor Temperature Error\n");
-                error_status = true;
+                break;
             }
+        }
+
+        /* Only the final poll is recorded */
+        pasco2_trace_read(*ppm, pressure_pa_x10, temperature_c_x100, result);
+    }
+
+    /* Resume the continuous measurement regardless of the single-shot result */
+    if (pasco2_set_measurement_rate(&xensiv_pasco2, (uint16_t)pasco2_active_period_s()) != CY_RSLT_SUCCESS)
+    {
+        printf("CO2 continuous measurement restart failed\n");
+    }
+
+    return result;
+#endif /* PASCO2_SENSOR_SOURCE */
+}
+
+/*******************************************************************************
+ * Function Name: pasco2_process_sample
+ *******************************************************************************
+ * Summary:
+ *   Runs the anomaly detectors on a new CO2 value. Alerts are sent to the
+ *   front of the publisher queue, so they overtake routine telemetry. The
+ *   routine telemetry is thinned to one out of 'PASCO2_TELEMETRY_DECIMATION'
+ *   samples, unless the sample raised an alert or was explicitly requested.
+ *
+ * Parameters:
+ *   ppm: CO2 value read from the sensor
+ *   timestamp_ms: UTC time of the read in milliseconds, 0 if unknown
+ *   force_publish: publish the telemetry regardless of the decimation
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void pasco2_process_sample(uint16_t ppm, uint64_t timestamp_ms, bool force_publish)
+{
+    const co2_alert_t alert = co2_analytics_update(&co2_analytics, ppm, pasco2_now_ms());
 
-            /* Turn-On warning LED to indicate warning to user from sensor */
-            cyhal_gpio_write(MTB_PASCO2_LED_WARNING, error_status ? MTB_PASCO_LED_STATE_ON : MTB_PASCO_LED_STATE_OFF);
+    if (alert != CO2_ALERT_NONE)
+    {
+        publisher_data_t publisher_q_data;
+        publisher_q_data.cmd = PUBLISH_MQTT_ALERT;
+        publisher_q_data.seq = ++publish_seq;
+        payload_writer_t writer;
+        payload_writer_init(&writer, publisher_q_data.data, sizeof(publisher_q_data.data));
+        payload_append_str(&writer, "{\"alert\": \"");
+        payload_append_str(&writer, co2_analytics_alert_name(alert));
+        payload_append_str(&writer, "\", \"ppm\": ");
+        payload_append_u32(&writer, ppm);
+        if (timestamp_ms != 0u)
+        {
+            payload_append_str(&writer, ", \"ts\": ");
+            payload_append_u64(&writer, timestamp_ms);
         }
+        payload_append_str(&writer, ", \"seq\": ");
+        payload_append_u32(&writer, publisher_q_data.seq);
+        payload_append_str(&writer, "}");
+        (void)publisher_post(&publisher_q_data);
+    }
+
+    telemetry_skip_count++;
+    if (force_publish || (alert != CO2_ALERT_NONE) || (telemetry_skip_count >= PASCO2_TELEMETRY_DECIMATION))
+    {
+        telemetry_skip_count = 0;
+        pasco2_publish_ppm(ppm, timestamp_ms);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: pasco2_publish_ppm
+ *******************************************************************************
+ * Summary:
+ *   Formats the CO2 value and sends it to the publisher task queue. The UTC
+ *   timestamp is only added once the time was synchronized.
+ *
+ * Parameters:
+ *   ppm: CO2 value read from the sensor
+ *   timestamp_ms: UTC time of the read in milliseconds, 0 if unknown
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void pasco2_publish_ppm(uint16_t ppm, uint64_t timestamp_ms)
+{
+    publisher_data_t publisher_q_data;
+    publisher_q_data.cmd = PUBLISH_MQTT_MSG;
+    publisher_q_data.seq = ++publish_seq;
+
+    /* Formatted without printf, this runs for every sample */
+    payload_writer_t writer;
+    payload_writer_init(&writer, publisher_q_data.data, sizeof(publisher_q_data.data));
+    payload_append_str(&writer, "{\"CO2 PPM Level\": \"");
+    payload_append_u32(&writer, ppm);
+    payload_append_str(&writer, "\"");
+    if (timestamp_ms != 0u)
+    {
+        payload_append_str(&writer, ", \"ts\": ");
+        payload_append_u64(&writer, timestamp_ms);
+    }
+    payload_append_str(&writer, ", \"seq\": ");
+    payload_append_u32(&writer, publisher_q_data.seq);
+    payload_append_str(&writer, "}");
+    /**
+     * Send message back to publish queue. If queue is full, 'local_pub_msg' will be dropped.
+     * The drop is only counted by the fault injection. */
+    if (publisher_post(&publisher_q_data) != pdPASS)
+    {
+        fault_injection_sample_lost();
+    }
+}
+
+/*******************************************************************************
+ * Function Name: pasco2_check_status
+ *******************************************************************************
+ * Summary:
+ *   Prints the errors reported in the PAS CO2 status register and drives the
+ *   warning LED accordingly.
+ *
+ * Parameters:
+ *   status: value of the PAS CO2 status register
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void pasco2_check_status(uint8_t status)
+{
+    bool error_status = false;
+    if (status & XENSIV_PASCO2_REG_SENS_STS_ICCER_MSK)
+    {
+        /* Sensor detected communication problem with MCU */
+        printf("CO2 Sensor Communication Error\n");
+        error_status = true;
+    }
 
-        vTaskDelay(pdMS_TO_TICKS(pasco2_process_delay_s*1000));
+    if (status & XENSIV_PASCO2_REG_SENS_STS_ORVS_MSK)
+    {
+        /* Sensor detected over-voltage problem */
+        printf("CO2 Sensor Over-Voltage Error\n");
+        error_status = true;
+    }
+
+    if (status & XENSIV_PASCO2_REG_SENS_STS_ORTMP_MSK)
+    {
+        /* Sensor detected temperature problem */
+        printf("CO2 Sensor Temperature Error\n");
+        error_status = true;
+    }
+
+    /* Turn-On warning LED to indicate warning to user from sensor */
+    cyhal_gpio_write(MTB_PASCO2_LED_WARNING, error_status ? MTB_PASCO_LED_STATE_ON : MTB_PASCO_LED_STATE_OFF);
+}
+
+/*******************************************************************************
+ * Function Name: pasco2_print_read_error
+ *******************************************************************************
+ * Summary:
+ *   Prints the reason of a failed CO2 read.
+ *
+ * Parameters:
+ *   result: result of xensiv_pasco2_mtb_read
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void pasco2_print_read_error(cy_rslt_t result)
+{
+    if (CY_RSLT_GET_CODE(result) == XENSIV_PASCO2_READ_NRDY)
+    {
+        /* New value is not available yet */
+        printf("CO2 PPM value is not ready\n");
+    }
+    else if (CY_RSLT_GET_CODE(result) == XENSIV_PASCO2_ERR_COMM)
+    {
+        /* I2C communication error */
+        printf("I2C communication error\n");
+    }
+    else
+    {
+        printf("Unexpected error\n");
     }
 }
 
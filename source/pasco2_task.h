@@ -31,6 +31,7 @@
 #include "FreeRTOS.h"
 #include "semphr.h"
 #include "task.h"
+#include "stack_size_config.h"
 
 /* Header file for library */
 #include "xensiv_pasco2_mtb.h"
@@ -40,7 +41,66 @@
  ******************************************************************************/
 #define PASCO2_TASK_NAME       "CO2 SENSOR TASK"
 #define PASCO2_TASK_PRIORITY   (2)
+#ifndef PASCO2_TASK_STACK_SIZE
 #define PASCO2_TASK_STACK_SIZE (1024 * 4)
+#endif
+
+/* Notification bits used by other tasks to wake up pasco2_task before the
+ * end of the current measurement period.
+ */
+#define PASCO2_NOTIFY_READ_NOW         (1UL << 0)
+#define PASCO2_NOTIFY_BURST_START      (1UL << 1)
+#define PASCO2_NOTIFY_PERIOD_CHANGED   (1UL << 2)
+#define PASCO2_NOTIFY_ADAPTIVE_CHANGED (1UL << 3)
+
+/* Valid range of the burst sampling duration in seconds */
+#define PASCO2_BURST_DURATION_MIN_S    (10U)
+#define PASCO2_BURST_DURATION_MAX_S    (3600U)
+
+/* Only one out of this many routine CO2 samples is published. Samples that
+ * raise an alert are always published. Set to 1 to publish every sample.
+ */
+#define PASCO2_TELEMETRY_DECIMATION    (1U)
+
+/* Source of the CO2 samples. The synthetic source runs the application
+ * without a PAS CO2 sensor, e.g. for broker and backend load tests with a
+ * fleet of boards. Each board generates its own sequence seeded from its
+ * unique ID. The replay source plays back the trace in sensor_trace_data.c.
+ */
+#define PASCO2_SENSOR_SOURCE_HW        (0)
+#define PASCO2_SENSOR_SOURCE_SYNTHETIC (1)
+#define PASCO2_SENSOR_SOURCE_REPLAY    (2)
+#ifndef PASCO2_SENSOR_SOURCE
+#define PASCO2_SENSOR_SOURCE           PASCO2_SENSOR_SOURCE_HW
+#endif
+
+/* Maximum random delay added to each measurement period. A non-zero value
+ * spreads the publish times of many boards that were started together.
+ */
+#define PASCO2_PUBLISH_JITTER_MS       (0U)
+
+/* The replay source waits this many times shorter than the measurement
+ * period. The detectors run on the recorded time, so a long trace runs
+ * through the whole pipeline in a fraction of the recorded time.
+ */
+#define PASCO2_REPLAY_SPEEDUP          (60U)
+
+/* The sample scheduler metrics (overruns and release jitter) are printed
+ * and published on the diagnostics topic every this many samples.
+ */
+#define PASCO2_SCHEDULE_REPORT_SAMPLES (60U)
+
+/* Set to 1 to take the continuous samples at UTC multiples of the
+ * measurement period (e.g. at :00, :10, :20 s with a period of 10 s) once
+ * the time is synchronized, so that the backend can aggregate the samples
+ * of many devices by time bucket. Each device adds a fixed phase below
+ * PASCO2_ALIGN_PHASE_SPREAD_MS, derived from its unique ID, which spreads
+ * the publishes of the fleet. Not used by the replay source.
+ */
+#ifndef PASCO2_UTC_ALIGNED_SAMPLING
+#define PASCO2_UTC_ALIGNED_SAMPLING    (0)
+#endif
+#define PASCO2_ALIGN_PHASE_SPREAD_MS   (2000U)
 
 
 /*******************************************************************************
@@ -52,10 +112,14 @@ extern SemaphoreHandle_t sem_pasco2_context;
 extern xensiv_pasco2_t xensiv_pasco2;
 extern cyhal_timer_t led_blink_timer;
 extern uint32_t pasco2_process_delay_s;
+extern uint32_t pasco2_burst_duration_s;
+extern bool pasco2_burst_active;
+extern bool pasco2_adaptive_enabled;
 /*******************************************************************************
  * Functions
  *******************************************************************************/
 void pasco2_task(void *pvParameters);
 void pasco2_task_cleanup(void);
+cy_rslt_t pasco2_set_measurement_rate(xensiv_pasco2_t *context, uint16_t period_s);
 
 /* [] END OF FILE */
@@ -0,0 +1,217 @@
+/******************************************************************************
+ * File Name:   payload_format.c
+ *
+ * Description: This file contains the integer-only payload formatter used in
+ *              the sample loop instead of snprintf. It needs neither the
+ *              printf engine nor floating point support from the C library.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#include "payload_format.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Number of decimal digits of UINT32_MAX */
+#define U32_MAX_DIGITS      (10U)
+
+/* Split factor of 64 bit values into two 32 bit divisions */
+#define U64_SPLIT_FACTOR    (1000000000U)
+#define U64_SPLIT_DIGITS    (9U)
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+static void payload_append_char(payload_writer_t *writer, char c);
+static void payload_terminate(payload_writer_t *writer);
+static void payload_append_digits(payload_writer_t *writer, uint32_t value, uint32_t min_digits);
+
+/*******************************************************************************
+ * Function Name: payload_writer_init
+ *******************************************************************************
+ * Summary:
+ *   Starts a new payload in the given buffer.
+ *
+ * Parameters:
+ *   writer: payload writer
+ *   buf: destination buffer
+ *   size: size of the destination buffer, must not be 0
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void payload_writer_init(payload_writer_t *writer, char *buf, size_t size)
+{
+    writer->buf = buf;
+    writer->size = size;
+    writer->len = 0;
+    writer->overflow = false;
+    writer->buf[0] = '\0';
+}
+
+/*******************************************************************************
+ * Function Name: payload_append_str
+ *******************************************************************************
+ * Summary:
+ *   Appends a null terminated string.
+ *
+ * Parameters:
+ *   writer: payload writer
+ *   str: string to append
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void payload_append_str(payload_writer_t *writer, const char *str)
+{
+    while (*str != '\0')
+    {
+        payload_append_char(writer, *str++);
+    }
+    payload_terminate(writer);
+}
+
+/*******************************************************************************
+ * Function Name: payload_append_u32
+ *******************************************************************************
+ * Summary:
+ *   Appends an unsigned 32 bit value in decimal.
+ *
+ * Parameters:
+ *   writer: payload writer
+ *   value: value to append
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void payload_append_u32(payload_writer_t *writer, uint32_t value)
+{
+    payload_append_digits(writer, value, 1U);
+}
+
+/*******************************************************************************
+ * Function Name: payload_append_u64
+ *******************************************************************************
+ * Summary:
+ *   Appends an unsigned 64 bit value in decimal. The value is split once into
+ *   32 bit parts, so the digits are produced with 32 bit divisions only.
+ *   Values below 2^32 * 10^9 are supported, which covers UTC milliseconds.
+ *
+ * Parameters:
+ *   writer: payload writer
+ *   value: value to append
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void payload_append_u64(payload_writer_t *writer, uint64_t value)
+{
+    if (value <= UINT32_MAX)
+    {
+        payload_append_digits(writer, (uint32_t)value, 1U);
+    }
+    else
+    {
+        payload_append_digits(writer, (uint32_t)(value / U64_SPLIT_FACTOR), 1U);
+        payload_append_digits(writer, (uint32_t)(value % U64_SPLIT_FACTOR), U64_SPLIT_DIGITS);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: payload_append_char
+ *******************************************************************************
+ * Summary:
+ *   Appends one character without the terminator, which is written once
+ *   by the public append functions. Characters that do not fit are dropped
+ *   and the overflow flag is set.
+ *
+ * Parameters:
+ *   writer: payload writer
+ *   c: character to append
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void payload_append_char(payload_writer_t *writer, char c)
+{
+    if ((writer->len + 1U) < writer->size)
+    {
+        writer->buf[writer->len++] = c;
+    }
+    else
+    {
+        writer->overflow = true;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: payload_terminate
+ *******************************************************************************
+ * Summary:
+ *   Writes the null terminator after the characters appended so far. The
+ *   size check of payload_append_char() keeps room for it.
+ *
+ * Parameters:
+ *   writer: payload writer
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void payload_terminate(payload_writer_t *writer)
+{
+    writer->buf[writer->len] = '\0';
+}
+
+/*******************************************************************************
+ * Function Name: payload_append_digits
+ *******************************************************************************
+ * Summary:
+ *   Appends the decimal digits of a 32 bit value, padded with leading zeros
+ *   to at least 'min_digits' digits.
+ *
+ * Parameters:
+ *   writer: payload writer
+ *   value: value to append
+ *   min_digits: minimum number of digits
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void payload_append_digits(payload_writer_t *writer, uint32_t value, uint32_t min_digits)
+{
+    char digits[U32_MAX_DIGITS];
+    uint32_t count = 0;
+
+    do
+    {
+        digits[count++] = (char)('0' + (value % 10U));
+        value /= 10U;
+    } while ((value != 0U) || (count < min_digits));
+
+    while (count > 0U)
+    {
+        payload_append_char(writer, digits[--count]);
+    }
+    payload_terminate(writer);
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,53 @@
+/******************************************************************************
+ * File Name:   payload_format.h
+ *
+ * Description: This file is the public interface of payload_format.c
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Typedefines
+ ******************************************************************************/
+/* Writer appending to a fixed size, always null terminated buffer */
+typedef struct
+{
+    char *buf;          /* Destination buffer */
+    size_t size;        /* Size of the destination buffer */
+    size_t len;         /* Characters written, without the terminator */
+    bool overflow;      /* Set when the output was truncated */
+} payload_writer_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+void payload_writer_init(payload_writer_t *writer, char *buf, size_t size);
+void payload_append_str(payload_writer_t *writer, const char *str);
+void payload_append_u32(payload_writer_t *writer, uint32_t value);
+void payload_append_u64(payload_writer_t *writer, uint64_t value);
+
+/* [] END OF FILE */
@@ -0,0 +1,128 @@
+/******************************************************************************
+ * File Name:   prng.c
+ *
+ * Description: This file contains a small xorshift32 pseudo random number
+ *              generator. It is used to spread timing (publish jitter,
+ *              reconnect backoff) and synthetic data across the devices of a
+ *              fleet, and is not suitable for cryptographic purposes.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#include "cyhal.h"
+
+#include "prng.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Replacement for a zero seed, xorshift never leaves the zero state */
+#define PRNG_DEFAULT_SEED   (0x9E3779B9UL)
+
+/*******************************************************************************
+ * Function Name: prng_device_seed
+ *******************************************************************************
+ * Summary:
+ *   Returns a seed derived from the unique die ID, so that every device of a
+ *   fleet produces a different but reproducible sequence.
+ *
+ * Parameters:
+ *   void
+ *
+ * Return:
+ *   uint32_t: device specific seed
+ ******************************************************************************/
+uint32_t prng_device_seed(void)
+{
+    const uint64_t unique_id = Cy_SysLib_GetUniqueId();
+
+    return (uint32_t)unique_id ^ (uint32_t)(unique_id >> 32);
+}
+
+/*******************************************************************************
+ * Function Name: prng_init
+ *******************************************************************************
+ * Summary:
+ *   Initializes the generator with the given seed.
+ *
+ * Parameters:
+ *   prng: generator state
+ *   seed: initial value, 0 is replaced by a fixed non-zero value
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void prng_init(prng_t *prng, uint32_t seed)
+{
+    prng->state = (seed != 0U) ? seed : PRNG_DEFAULT_SEED;
+}
+
+/*******************************************************************************
+ * Function Name: prng_next
+ *******************************************************************************
+ * Summary:
+ *   Returns the next pseudo random value.
+ *
+ * Parameters:
+ *   prng: generator state
+ *
+ * Return:
+ *   uint32_t: pseudo random value
+ ******************************************************************************/
+uint32_t prng_next(prng_t *prng)
+{
+    uint32_t x = prng->state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    prng->state = x;
+
+    return x;
+}
+
+/*******************************************************************************
+ * Function Name: prng_range
+ *******************************************************************************
+ * Summary:
+ *   Returns a pseudo random value in the inclusive range [min, max].
+ *
+ * Parameters:
+ *   prng: generator state
+ *   min: lower bound
+ *   max: upper bound, must not be lower than 'min'
+ *
+ * Return:
+ *   uint32_t: pseudo random value
+ ******************************************************************************/
+uint32_t prng_range(prng_t *prng, uint32_t min, uint32_t max)
+{
+    const uint32_t span = max - min;
+
+    if (span == UINT32_MAX)
+    {
+        return prng_next(prng);
+    }
+
+    return min + (prng_next(prng) % (span + 1U));
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,50 @@
+/******************************************************************************
+ * File Name:   prng.h
+ *
+ * Description: This file is the public interface of prng.c
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*******************************************************************************
+ * Typedefines
+ ******************************************************************************/
+/* State of a xorshift32 pseudo random number generator. Each user keeps its
+ * own state, so no locking is needed between tasks.
+ */
+typedef struct
+{
+    uint32_t state;
+} prng_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+uint32_t prng_device_seed(void);
+void prng_init(prng_t *prng, uint32_t seed);
+uint32_t prng_next(prng_t *prng);
+uint32_t prng_range(prng_t *prng, uint32_t min, uint32_t max);
+
+/* [] END OF FILE */
@@ -0,0 +1,330 @@
+/******************************************************************************
+ * File Name:   publish_retry.c
+ *
+ * Description: This file contains the redelivery ring of the publisher. Failed
+ *              telemetry and alert messages are kept unchanged, with their
+ *              original time stamp and sequence number, and are published again
+ *              in their original order once the connection recovered.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "fault_injection.h"
+#include "publish_retry.h"
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+/* A held message and its failed redeliveries */
+typedef struct
+{
+    publisher_data_t message;
+    uint32_t attempts;
+} publish_retry_entry_t;
+
+/* Ring of the failed messages in the order of their sequence numbers, oldest
+ * at 'retry_head'. Only written by the publisher, the counters are also read
+ * by other tasks.
+ */
+static publish_retry_entry_t retry_ring[PUBLISH_RETRY_RING_LENGTH];
+static uint32_t retry_head = 0;
+static publish_retry_stats_t retry_stats;
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+static publish_retry_entry_t *publish_retry_slot(uint32_t index);
+static bool publish_retry_is_older(uint32_t seq, uint32_t other_seq);
+static void publish_retry_remove(uint32_t index);
+
+/*******************************************************************************
+ * Function Name: publish_retry_push
+ *******************************************************************************
+ * Summary:
+ *   Inserts a failed message into the ring in the order of its sequence
+ *   number. Alerts jump the publisher queue, so they can fail before older
+ *   telemetry. A message with the sequence number of a queued message is not
+ *   queued again. When the ring is full, the oldest telemetry message of the
+ *   ring and the new message is dropped to make room. An alert is only
+ *   dropped if there is no telemetry to drop.
+ *
+ * Parameters:
+ *   message: failed message, its sequence number must not be 0
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void publish_retry_push(const publisher_data_t *message)
+{
+    uint32_t index;
+
+    for (index = 0; index < retry_stats.depth; index++)
+    {
+        if (publish_retry_slot(index)->message.seq == message->seq)
+        {
+            taskENTER_CRITICAL();
+            retry_stats.duplicates++;
+            taskEXIT_CRITICAL();
+            return;
+        }
+    }
+
+    if (retry_stats.depth == PUBLISH_RETRY_RING_LENGTH)
+    {
+        /* The ring is sorted, so the first telemetry message is the oldest.
+         * PUBLISH_RETRY_RING_LENGTH stands for the new message.
+         */
+        uint32_t victim = PUBLISH_RETRY_RING_LENGTH;
+
+        for (index = 0; index < retry_stats.depth; index++)
+        {
+            if (publish_retry_slot(index)->message.cmd == PUBLISH_MQTT_MSG)
+            {
+                victim = index;
+                break;
+            }
+        }
+
+        if (victim == PUBLISH_RETRY_RING_LENGTH)
+        {
+            /* Only alerts are held, keep a new telemetry message out */
+            if ((message->cmd != PUBLISH_MQTT_MSG) && publish_retry_is_older(publish_retry_slot(0)->message.seq, message->seq))
+            {
+                victim = 0;
+            }
+        }
+        else if ((message->cmd == PUBLISH_MQTT_MSG) &&
+                 publish_retry_is_older(message->seq, publish_retry_slot(victim)->message.seq))
+        {
+            victim = PUBLISH_RETRY_RING_LENGTH;
+        }
+
+        taskENTER_CRITICAL();
+        retry_stats.dropped++;
+        taskEXIT_CRITICAL();
+        fault_injection_sample_lost();
+
+        if (victim == PUBLISH_RETRY_RING_LENGTH)
+        {
+            return;
+        }
+        publish_retry_remove(victim);
+    }
+
+    /* Move the newer messages up by one slot */
+    for (index = retry_stats.depth; index > 0u; index--)
+    {
+        if (!publish_retry_is_older(message->seq, publish_retry_slot(index - 1u)->message.seq))
+        {
+            break;
+        }
+        memcpy(publish_retry_slot(index), publish_retry_slot(index - 1u), sizeof(publish_retry_entry_t));
+    }
+    memcpy(&publish_retry_slot(index)->message, message, sizeof(publisher_data_t));
+    publish_retry_slot(index)->attempts = 0;
+
+    taskENTER_CRITICAL();
+    retry_stats.depth++;
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+ * Function Name: publish_retry_peek
+ *******************************************************************************
+ * Summary:
+ *   Returns the oldest message of the ring without removing it.
+ *
+ * Parameters:
+ *   void
+ *
+ * Return:
+ *   const publisher_data_t *: oldest message, NULL if the ring is empty
+ ******************************************************************************/
+const publisher_data_t *publish_retry_peek(void)
+{
+    return (retry_stats.depth > 0u) ? &retry_ring[retry_head].message : NULL;
+}
+
+/*******************************************************************************
+ * Function Name: publish_retry_pop
+ *******************************************************************************
+ * Summary:
+ *   Removes the oldest message after it was published.
+ *
+ * Parameters:
+ *   void
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void publish_retry_pop(void)
+{
+    taskENTER_CRITICAL();
+    if (retry_stats.depth > 0u)
+    {
+        retry_head = (retry_head + 1u) % PUBLISH_RETRY_RING_LENGTH;
+        retry_stats.depth--;
+        retry_stats.redelivered++;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+ * Function Name: publish_retry_failed
+ *******************************************************************************
+ * Summary:
+ *   Counts a failed redelivery of the oldest message. After
+ *   PUBLISH_RETRY_MAX_ATTEMPTS failed redeliveries the message is dropped,
+ *   so that a message the broker keeps refusing does not block the ring.
+ *
+ * Parameters:
+ *   void
+ *
+ * Return:
+ *   bool: true if the message was dropped
+ ******************************************************************************/
+bool publish_retry_failed(void)
+{
+    if (retry_stats.depth == 0u)
+    {
+        return false;
+    }
+
+    publish_retry_slot(0)->attempts++;
+    if (publish_retry_slot(0)->attempts < PUBLISH_RETRY_MAX_ATTEMPTS)
+    {
+        return false;
+    }
+
+    taskENTER_CRITICAL();
+    retry_head = (retry_head + 1u) % PUBLISH_RETRY_RING_LENGTH;
+    retry_stats.depth--;
+    retry_stats.dropped++;
+    taskEXIT_CRITICAL();
+    fault_injection_sample_lost();
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: publish_retry_is_empty
+ *******************************************************************************
+ * Summary:
+ *   Tells whether messages wait for the redelivery. Newer messages have to
+ *   be queued behind them to keep the order.
+ *
+ * Parameters:
+ *   void
+ *
+ * Return:
+ *   bool: true if the ring is empty
+ ******************************************************************************/
+bool publish_retry_is_empty(void)
+{
+    return (retry_stats.depth == 0u);
+}
+
+/*******************************************************************************
+ * Function Name: publish_retry_get_stats
+ *******************************************************************************
+ * Summary:
+ *   Returns a consistent copy of the ring counters. Can be called from any
+ *   task.
+ *
+ * Parameters:
+ *   stats: the counters are copied here
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void publish_retry_get_stats(publish_retry_stats_t *stats)
+{
+    taskENTER_CRITICAL();
+    *stats = retry_stats;
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+ * Function Name: publish_retry_slot
+ *******************************************************************************
+ * Summary:
+ *   Returns the slot of the ring that holds the message at a position.
+ *
+ * Parameters:
+ *   index: position of the message, 0 is the oldest
+ *
+ * Return:
+ *   publish_retry_entry_t *: slot of the message
+ ******************************************************************************/
+static publish_retry_entry_t *publish_retry_slot(uint32_t index)
+{
+    return &retry_ring[(retry_head + index) % PUBLISH_RETRY_RING_LENGTH];
+}
+
+/*******************************************************************************
+ * Function Name: publish_retry_is_older
+ *******************************************************************************
+ * Summary:
+ *   Compares two sequence numbers, allowing for their wrap-around.
+ *
+ * Parameters:
+ *   seq: sequence number to compare
+ *   other_seq: sequence number to compare with
+ *
+ * Return:
+ *   bool: true if 'seq' was assigned before 'other_seq'
+ ******************************************************************************/
+static bool publish_retry_is_older(uint32_t seq, uint32_t other_seq)
+{
+    return ((int32_t)(seq - other_seq) < 0);
+}
+
+/*******************************************************************************
+ * Function Name: publish_retry_remove
+ *******************************************************************************
+ * Summary:
+ *   Removes the message at a position and moves the newer messages down by
+ *   one slot.
+ *
+ * Parameters:
+ *   index: position of the message, 0 is the oldest
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void publish_retry_remove(uint32_t index)
+{
+    for (; (index + 1u) < retry_stats.depth; index++)
+    {
+        memcpy(publish_retry_slot(index), publish_retry_slot(index + 1u), sizeof(publish_retry_entry_t));
+    }
+
+    taskENTER_CRITICAL();
+    retry_stats.depth--;
+    taskEXIT_CRITICAL();
+}
+
+/* [] END OF FILE */
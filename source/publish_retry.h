@@ -0,0 +1,74 @@
+/******************************************************************************
+ * File Name:   publish_retry.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *              in publish_retry.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "publisher_task.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Number of failed or held messages kept for the redelivery. When the ring
+ * is full, the oldest telemetry message is dropped, alerts only when no
+ * telemetry is held. Each message takes about 100 bytes
+ * of RAM, increase the length to hold the samples of longer outages.
+ */
+#ifndef PUBLISH_RETRY_RING_LENGTH
+#define PUBLISH_RETRY_RING_LENGTH   (8u)
+#endif
+
+/* Failed redeliveries after which a message is dropped from the ring */
+#ifndef PUBLISH_RETRY_MAX_ATTEMPTS
+#define PUBLISH_RETRY_MAX_ATTEMPTS  (5u)
+#endif
+
+/*******************************************************************************
+ * Typedefines
+ ******************************************************************************/
+/* Counters of the redelivery ring */
+typedef struct
+{
+    uint32_t depth;             /* Messages waiting for the redelivery */
+    uint32_t dropped;           /* Messages dropped, ring full or redelivery failed */
+    uint32_t redelivered;       /* Messages published from the ring */
+    uint32_t duplicates;        /* Messages not queued again, same sequence number */
+} publish_retry_stats_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+void publish_retry_push(const publisher_data_t *message);
+const publisher_data_t *publish_retry_peek(void);
+void publish_retry_pop(void);
+bool publish_retry_failed(void);
+bool publish_retry_is_empty(void);
+void publish_retry_get_stats(publish_retry_stats_t *stats);
+
+/* [] END OF FILE */
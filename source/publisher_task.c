@@ -31,6 +31,11 @@
 #include "FreeRTOS.h"
 
 /* Task header files */
+#include "app_alloc.h"
+#include "conn_timing.h"
+#include "fault_injection.h"
+#include "mqtt_event_ring.h"
+#include "publish_retry.h"
 #include "publisher_task.h"
 #include "mqtt_task.h"
 #include "subscriber_task.h"
@@ -53,10 +58,47 @@
  */
 #define PUBLISH_RETRY_MS                (1000)
 
-/* Queue length of a message queue that is used to communicate with the
- * publisher task.
- */
-#define PUBLISHER_TASK_QUEUE_LENGTH     (3u)
+/*******************************************************************************
+ * Typedefines
+ ******************************************************************************/
+/* Message classes, each with its own topic, QoS, retain flag and priority */
+typedef enum
+{
+    PUBLISH_CLASS_TELEMETRY,
+    PUBLISH_CLASS_ALERT,
+    PUBLISH_CLASS_CONFIG_ACK,
+    PUBLISH_CLASS_DIAG,
+    PUBLISH_CLASS_COUNT
+} publish_class_id_t;
+
+/* Queue priority of a message class, see publisher_post() */
+typedef enum
+{
+    PUBLISH_PRIORITY_LOW,
+    PUBLISH_PRIORITY_NORMAL,
+    PUBLISH_PRIORITY_HIGH
+} publish_priority_t;
+
+/* Publish timing of a message class */
+typedef struct
+{
+    uint32_t count;             /* Publishes since the last report */
+    uint32_t failed;            /* Failed publishes since the last report */
+    uint32_t ms_sum;            /* Sum of the publish times */
+    uint32_t ms_max;            /* Longest publish time */
+    TickType_t start_tick;      /* Time of the first publish */
+} publish_class_stats_t;
+
+typedef struct
+{
+    const char *name;
+    const char *topic_template;
+    mqtt_topic_id_t topic;      /* Interned by publisher_init() */
+    cy_mqtt_qos_t qos;
+    bool retain;
+    publish_priority_t priority;
+    publish_class_stats_t stats;
+} publish_class_t;
 
 /******************************************************************************
 * Global Variables
@@ -66,17 +108,69 @@ TaskHandle_t publisher_task_handle;
 
 /* Handle of the queue holding the commands for the publisher task */
 QueueHandle_t publisher_task_q;
+APP_QUEUE_MEMORY(publisher_task_q, PUBLISHER_TASK_QUEUE_LENGTH, sizeof(publisher_data_t));
 
-/* Structure to store publish message information. */
-cy_mqtt_publish_info_t publish_info =
+/* Topic, QoS, retain flag and queue priority of each message class, and
+ * the publish timing of the class since its last report.
+ */
+static publish_class_t publish_classes[PUBLISH_CLASS_COUNT] =
 {
-    .qos = (cy_mqtt_qos_t) MQTT_MESSAGES_QOS,
-    .topic = MQTT_PUB_TOPIC,
-    .topic_len = (sizeof(MQTT_PUB_TOPIC) - 1),
-    .retain = false,
-    .dup = false
+    [PUBLISH_CLASS_TELEMETRY] =
+    {
+        .name = "telemetry",
+        .topic_template = MQTT_PUB_TOPIC,
+        .qos = (cy_mqtt_qos_t) MQTT_TELEMETRY_QOS,
+        .retain = false,
+        .priority = PUBLISH_PRIORITY_NORMAL
+    },
+    [PUBLISH_CLASS_ALERT] =
+    {
+        .name = "alert",
+        .topic_template = MQTT_ALERT_TOPIC,
+        .qos = (cy_mqtt_qos_t) MQTT_ALERT_QOS,
+        .retain = false,
+        .priority = PUBLISH_PRIORITY_HIGH
+    },
+    [PUBLISH_CLASS_CONFIG_ACK] =
+    {
+        .name = "config_ack",
+        .topic_template = MQTT_CONFIG_ACK_TOPIC,
+        .qos = (cy_mqtt_qos_t) MQTT_CONFIG_ACK_QOS,
+        .retain = false,
+        .priority = PUBLISH_PRIORITY_NORMAL
+    },
+    [PUBLISH_CLASS_DIAG] =
+    {
+        .name = "diag",
+        .topic_template = MQTT_DIAG_TOPIC,
+        .qos = (cy_mqtt_qos_t) MQTT_DIAG_QOS,
+        .retain = false,
+        .priority = PUBLISH_PRIORITY_LOW
+    }
 };
 
+/* True between PUBLISHER_DEINIT and PUBLISHER_INIT, while the connection is
+ * down. The samples are held in the redelivery ring meanwhile.
+ */
+static bool publisher_paused = false;
+
+/* Earliest time of the next publish from the redelivery ring */
+static TickType_t next_flush_tick;
+
+/* Messages published from the redelivery ring since it was last empty */
+static uint32_t flush_count = 0;
+
+/******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static bool publisher_is_paused(void);
+static void publish_data(const publisher_data_t *message);
+static void publish_retry_report(void);
+static publish_class_t *publish_class_of(publisher_cmd_t cmd);
+static void publisher_describe(publisher_data_t *message);
+static cy_rslt_t publish_message(const publisher_data_t *message);
+static void publish_class_report(publish_class_t *publish_class);
+
 /******************************************************************************
  * Function Name: publisher_task
  ******************************************************************************
@@ -95,65 +189,537 @@ cy_mqtt_publish_info_t publish_info =
  ******************************************************************************/
 void publisher_task(void *pvParameters)
 {
-    /* Status variable */
-    cy_rslt_t result;
-
     publisher_data_t publisher_q_data;
 
-    /* Command to the MQTT client task */
-    mqtt_task_cmd_t mqtt_task_cmd;
-
     /* To avoid compiler warnings */
     (void) pvParameters;
 
-    /* Create a message queue to communicate with other tasks and callbacks. */
-    publisher_task_q = xQueueCreate(PUBLISHER_TASK_QUEUE_LENGTH, sizeof(publisher_data_t));
+    publisher_init();
 
     while (true)
     {
-        /* Wait for commands from other tasks and callbacks. */
-        if (pdTRUE == xQueueReceive(publisher_task_q, &publisher_q_data, portMAX_DELAY))
+        /* Wait for commands from other tasks and callbacks, or for the
+         * next publish from the redelivery ring.
+         */
+        if (pdTRUE == xQueueReceive(publisher_task_q, &publisher_q_data, publisher_wait_ticks()))
+        {
+            publisher_handle(&publisher_q_data);
+        }
+        publisher_flush_step();
+    }
+}
+
+/******************************************************************************
+ * Function Name: publisher_init
+ ******************************************************************************
+ * Summary:
+ *  Function that interns the topics of the message classes and creates the
+ *  message queue of the publisher. Called by the publisher task, or by the
+ *  event loop task in the APP_EVENT_LOOP_ENABLED build.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void publisher_init(void)
+{
+    /* The topics are interned before any message can refer to them. A topic
+     * that cannot be interned is a configuration error.
+     */
+    for (uint32_t index = 0; index < PUBLISH_CLASS_COUNT; index++)
+    {
+        publish_classes[index].topic = mqtt_topic_intern(publish_classes[index].topic_template);
+        if (publish_classes[index].topic == MQTT_TOPIC_INVALID)
+        {
+            printf("Invalid MQTT topic of the %s messages!\n", publish_classes[index].name);
+            CY_ASSERT(0);
+        }
+    }
+
+    /* Create a message queue to communicate with other tasks and callbacks. */
+    publisher_task_q = APP_QUEUE_CREATE(publisher_task_q, PUBLISHER_TASK_QUEUE_LENGTH, sizeof(publisher_data_t));
+
+    /* Let the MQTT client task start the sensor task. */
+    xEventGroupSetBits(mqtt_status_events, MQTT_STATUS_PUBLISHER_READY);
+
+    /* The first connection setup completed before the publisher existed. */
+    conn_timing_publish_pending();
+}
+
+/******************************************************************************
+ * Function Name: publisher_handle
+ ******************************************************************************
+ * Summary:
+ *  Function that performs one command received over the message queue of
+ *  the publisher.
+ *
+ * Parameters:
+ *  const publisher_data_t *publisher_q_data : command and its payload
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void publisher_handle(const publisher_data_t *publisher_q_data)
+{
+    switch(publisher_q_data->cmd)
+    {
+        case PUBLISHER_INIT:
+        {
+            /* The connection recovered, flush the held messages at the
+             * rate of MQTT_PUB_FLUSH_INTERVAL_MS.
+             */
+            publisher_paused = false;
+            next_flush_tick = xTaskGetTickCount();
+            break;
+        }
+
+        case PUBLISHER_DEINIT:
+        {
+            /* Hold the messages until the connection recovered. */
+            publisher_paused = true;
+            break;
+        }
+
+        case PUBLISH_MQTT_MSG:
+        case PUBLISH_MQTT_ALERT:
+        case PUBLISH_MQTT_CONFIG_ACK:
+        case PUBLISH_MQTT_DIAG:
+        {
+            /* Publish the data received over the message queue on the
+             * topic of the command.
+             */
+            publish_data(publisher_q_data);
+            break;
+        }
+    }
+}
+
+/******************************************************************************
+ * Function Name: publisher_is_paused
+ ******************************************************************************
+ * Summary:
+ *  Returns whether the messages must be held. The connection status bit is
+ *  cleared by the MQTT callback as soon as the connection is lost, before
+ *  PUBLISHER_DEINIT reaches the publisher.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  bool : true while paused or disconnected
+ *
+ ******************************************************************************/
+static bool publisher_is_paused(void)
+{
+    return publisher_paused || !mqtt_wait_status(MQTT_STATUS_CONNECTED, 0);
+}
+
+/******************************************************************************
+ * Function Name: publish_data
+ ******************************************************************************
+ * Summary:
+ *  Publishes a message received over the message queue. A failed message
+ *  with a sequence number is kept for the redelivery. While the publisher
+ *  is paused or older messages wait for the redelivery, a new message is
+ *  queued behind them, so that the messages reach the broker in the order
+ *  of their sequence numbers. A message without a sequence number is dropped while
+ *  the publisher is paused.
+ *
+ * Parameters:
+ *  const publisher_data_t *message : command, sequence number and payload
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void publish_data(const publisher_data_t *message)
+{
+    if (message->seq == 0u)
+    {
+        if (publisher_is_paused())
+        {
+            printf("  Publisher: Paused, dropped '%s'\n\n", message->data);
+        }
+        else
         {
-            switch(publisher_q_data.cmd)
+            /* Not a CO2 sample, so a failure is not counted as a lost one */
+            (void)publish_message(message);
+        }
+        return;
+    }
+
+    if (publisher_is_paused() || !publish_retry_is_empty())
+    {
+        publish_retry_push(message);
+        return;
+    }
+
+    if (publish_message(message) != CY_RSLT_SUCCESS)
+    {
+        publish_retry_push(message);
+    }
+}
+
+/******************************************************************************
+ * Function Name: publisher_wait_ticks
+ ******************************************************************************
+ * Summary:
+ *  Returns the time the publisher can wait for a new command before the
+ *  next message of the redelivery ring is due.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  TickType_t : ticks to wait, portMAX_DELAY if nothing is to be flushed
+ *
+ ******************************************************************************/
+TickType_t publisher_wait_ticks(void)
+{
+    const TickType_t now_tick = xTaskGetTickCount();
+
+    if (publisher_is_paused() || publish_retry_is_empty())
+    {
+        return portMAX_DELAY;
+    }
+
+    return ((int32_t)(next_flush_tick - now_tick) > 0) ? (next_flush_tick - now_tick) : 0u;
+}
+
+/******************************************************************************
+ * Function Name: publisher_flush_step
+ ******************************************************************************
+ * Summary:
+ *  Publishes the oldest message of the redelivery ring if the publisher is
+ *  not paused and the message is due. At most one message is published per
+ *  MQTT_PUB_FLUSH_INTERVAL_MS. A failed message stays in the ring and is
+ *  tried again after the interval, up to PUBLISH_RETRY_MAX_ATTEMPTS times.
+ *  Then it is dropped and counted as dropped.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void publisher_flush_step(void)
+{
+    const publisher_data_t *message = publish_retry_peek();
+    const TickType_t now_tick = xTaskGetTickCount();
+
+    if (publisher_is_paused() || (message == NULL) || ((int32_t)(next_flush_tick - now_tick) > 0))
+    {
+        return;
+    }
+
+    next_flush_tick = now_tick + pdMS_TO_TICKS(MQTT_PUB_FLUSH_INTERVAL_MS);
+    if (publish_message(message) == CY_RSLT_SUCCESS)
+    {
+        publish_retry_pop();
+        flush_count++;
+    }
+    else if (publish_retry_failed())
+    {
+        printf("  Publisher: Redelivery failed %u times, dropped the message\n\n",
+               (unsigned int)PUBLISH_RETRY_MAX_ATTEMPTS);
+    }
+    else
+    {
+        return;
+    }
+
+    if (publish_retry_is_empty())
+    {
+        publish_retry_report();
+        flush_count = 0;
+    }
+}
+
+/******************************************************************************
+ * Function Name: publish_retry_report
+ ******************************************************************************
+ * Summary:
+ *  Prints the counters of the redelivery ring and queues them for the
+ *  diagnostics topic once the ring was flushed. Like every diagnostics
+ *  message, the report is dropped if the publisher is paused when it is
+ *  taken from the queue.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void publish_retry_report(void)
+{
+    publish_retry_stats_t stats;
+    publisher_data_t diag;
+
+    publish_retry_get_stats(&stats);
+    printf("  Publisher: Redelivered %lu messages, %lu in total, %lu dropped\n\n",
+           (unsigned long)flush_count, (unsigned long)stats.redelivered, (unsigned long)stats.dropped);
+
+    diag.cmd = PUBLISH_MQTT_DIAG;
+    diag.seq = 0;
+    snprintf(diag.data, sizeof(diag.data),
+             "{\"retry_depth\":%lu,\"redelivered\":%lu,\"dropped\":%lu,\"dup\":%lu}",
+             (unsigned long)stats.depth, (unsigned long)stats.redelivered,
+             (unsigned long)stats.dropped, (unsigned long)stats.duplicates);
+    (void)publisher_post(&diag);
+}
+
+/******************************************************************************
+ * Function Name: publish_class_of
+ ******************************************************************************
+ * Summary:
+ *  Returns the message class of a publish command.
+ *
+ * Parameters:
+ *  publisher_cmd_t cmd : one of the PUBLISH_MQTT_* commands
+ *
+ * Return:
+ *  publish_class_t * : topic, QoS, retain flag and priority of the command
+ *
+ ******************************************************************************/
+static publish_class_t *publish_class_of(publisher_cmd_t cmd)
+{
+    switch (cmd)
+    {
+        case PUBLISH_MQTT_ALERT:
+            return &publish_classes[PUBLISH_CLASS_ALERT];
+
+        case PUBLISH_MQTT_CONFIG_ACK:
+            return &publish_classes[PUBLISH_CLASS_CONFIG_ACK];
+
+        case PUBLISH_MQTT_DIAG:
+            return &publish_classes[PUBLISH_CLASS_DIAG];
+
+        default:
+            return &publish_classes[PUBLISH_CLASS_TELEMETRY];
+    }
+}
+
+/******************************************************************************
+ * Function Name: publisher_describe
+ ******************************************************************************
+ * Summary:
+ *  Fills the publish descriptor of a message from the class of its command
+ *  and the length of its payload.
+ *
+ * Parameters:
+ *  publisher_data_t *message : message with its command and payload set
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void publisher_describe(publisher_data_t *message)
+{
+    const publish_class_t *publish_class = publish_class_of(message->cmd);
+
+    message->desc.topic = publish_class->topic;
+    message->desc.qos = (uint8_t)publish_class->qos;
+    message->desc.retain = publish_class->retain;
+    message->desc.payload_len = (uint16_t)strnlen(message->data, sizeof(message->data) - 1u);
+}
+
+/******************************************************************************
+ * Function Name: publisher_post
+ ******************************************************************************
+ * Summary:
+ *  Fills the publish descriptor of a message and queues the message for the
+ *  publisher according to the priority of its class, without waiting. High
+ *  priority messages are queued in front of the others. Low priority
+ *  messages are only queued while more than PUBLISHER_QUEUE_RESERVED_SLOTS
+ *  slots are free, so that they never take the last slot from telemetry or
+ *  an alert. The priority only applies to the queue: while telemetry waits
+ *  in the redelivery ring, an alert is held behind it in the order of the
+ *  sequence numbers and waits up to PUBLISH_RETRY_RING_LENGTH times
+ *  MQTT_PUB_FLUSH_INTERVAL_MS. Called by the producers of the messages.
+ *
+ * Parameters:
+ *  publisher_data_t *message : command, sequence number and payload
+ *
+ * Return:
+ *  BaseType_t : pdPASS if the message was queued
+ *
+ ******************************************************************************/
+BaseType_t publisher_post(publisher_data_t *message)
+{
+    if (publisher_task_q == NULL)
+    {
+        return pdFAIL;
+    }
+
+    publisher_describe(message);
+
+    switch (publish_class_of(message->cmd)->priority)
+    {
+        case PUBLISH_PRIORITY_HIGH:
+            return xQueueSendToFront(publisher_task_q, message, 0);
+
+        case PUBLISH_PRIORITY_LOW:
+            if (uxQueueSpacesAvailable(publisher_task_q) <= PUBLISHER_QUEUE_RESERVED_SLOTS)
             {
-                case PUBLISHER_INIT:
-                {
-                    /* Reserved for customer extension. */
-                    break;
-                }
-
-                case PUBLISHER_DEINIT:
-                {
-                    /* Reserved for customer extension. */
-                    break;
-                }
-
-                case PUBLISH_MQTT_MSG:
-                {
-                    /* Publish the data received over the message queue. */
-                    publish_info.payload = publisher_q_data.data;
-                    publish_info.payload_len = strlen(publish_info.payload);
-
-                    printf("  Publisher: Publishing '%s' on the topic '%s'\n\n",
-                           (char *) publish_info.payload, publish_info.topic);
-
-                    result = cy_mqtt_publish(mqtt_connection, &publish_info);
-
-                    if (result != CY_RSLT_SUCCESS)
-                    {
-                        printf("  Publisher: MQTT Publish failed with error 0x%0X.\n\n", (int)result);
-
-                        /* Communicate the publish failure with the the MQTT
-                         * client task.
-                         */
-                        mqtt_task_cmd = HANDLE_MQTT_PUBLISH_FAILURE;
-                        xQueueSend(mqtt_task_q, &mqtt_task_cmd, portMAX_DELAY);
-                    }
-                    break;
-                }
+                return pdFAIL;
             }
+            return xQueueSendToBack(publisher_task_q, message, 0);
+
+        default:
+            return xQueueSendToBack(publisher_task_q, message, 0);
+    }
+}
+
+/******************************************************************************
+ * Function Name: publish_message
+ ******************************************************************************
+ * Summary:
+ *  Publishes a message with the topic, QoS and retain flag of its
+ *  descriptor, times the publish and reports a failure to the MQTT client
+ *  task. The publish information is built on the stack for each message.
+ *
+ * Parameters:
+ *  const publisher_data_t *message : described message
+ *
+ * Return:
+ *  cy_rslt_t : result of the publish. A publish dropped by the fault
+ *              injection counts as published, it is lost on the way. So
+ *              does a message with an invalid or empty topic.
+ *
+ ******************************************************************************/
+static cy_rslt_t publish_message(const publisher_data_t *message)
+{
+    publish_class_t *publish_class = publish_class_of(message->cmd);
+    publish_class_stats_t *stats = &publish_class->stats;
+    cy_mqtt_publish_info_t info =
+    {
+        .qos = (cy_mqtt_qos_t)message->desc.qos,
+        .retain = message->desc.retain,
+        .dup = false,
+        .topic = mqtt_topic_name(message->desc.topic),
+        .topic_len = mqtt_topic_len(message->desc.topic),
+        .payload = message->data,
+        .payload_len = message->desc.payload_len
+    };
+    TickType_t start_tick;
+    uint32_t publish_ms;
+
+    /* Status variable */
+    cy_rslt_t result;
+
+    /* A message without a topic can never be published, so it is dropped
+     * instead of being kept for the redelivery.
+     */
+    if (info.topic_len == 0u)
+    {
+        printf("  Publisher: No valid topic, dropped '%s'\n\n", message->data);
+        stats->failed++;
+        return CY_RSLT_SUCCESS;
+    }
+
+    /* Injected publish faults, no-ops unless FAULT_INJECTION_ENABLED is set */
+    if (fault_injection_drop_publish())
+    {
+        printf("  Publisher: Dropped '%s' by fault injection\n\n", message->data);
+        if (message->seq != 0u)
+        {
+            fault_injection_sample_lost();
         }
+        return CY_RSLT_SUCCESS;
+    }
+    if (fault_injection_publish_delay_ms() != 0u)
+    {
+        vTaskDelay(pdMS_TO_TICKS(fault_injection_publish_delay_ms()));
+    }
+
+    printf("  Publisher: Publishing '%s' on the topic '%s'\n\n",
+           message->data, info.topic);
+
+    /* With QoS 1 the publish returns after the PUBACK, with QoS 0 once the
+     * message is sent.
+     */
+    start_tick = xTaskGetTickCount();
+    result = cy_mqtt_publish(mqtt_connection, &info);
+    publish_ms = (uint32_t)(xTaskGetTickCount() - start_tick) * portTICK_PERIOD_MS;
+
+    if (stats->count == 0u)
+    {
+        stats->start_tick = start_tick;
+    }
+    stats->count++;
+    stats->ms_sum += publish_ms;
+    if (publish_ms > stats->ms_max)
+    {
+        stats->ms_max = publish_ms;
+    }
+
+    if (result != CY_RSLT_SUCCESS)
+    {
+        printf("  Publisher: MQTT Publish failed with error 0x%0X.\n\n", (int)result);
+        stats->failed++;
+
+        /* Communicate the publish failure with the the MQTT
+         * client task.
+         */
+        (void)mqtt_event_post(HANDLE_MQTT_PUBLISH_FAILURE);
+    }
+
+    /* The diagnostics class carries the reports and is not reported itself */
+    if ((stats->count >= PUBLISHER_CLASS_REPORT_COUNT) &&
+        (publish_class != &publish_classes[PUBLISH_CLASS_DIAG]))
+    {
+        publish_class_report(publish_class);
     }
+
+    return result;
+}
+
+/******************************************************************************
+ * Function Name: publish_class_report
+ ******************************************************************************
+ * Summary:
+ *  Publishes the number of messages, the failures, the average and longest
+ *  publish time, and the time span of the last PUBLISHER_CLASS_REPORT_COUNT
+ *  messages of a class on the diagnostics topic, and restarts the counters.
+ *  The report is queued, so it is not published on a connection that was
+ *  lost meanwhile, see publish_data().
+ *  Comparing the classes shows the cost of their QoS, e.g. of telemetry with
+ *  QoS 0 against alerts with QoS 1.
+ *
+ * Parameters:
+ *  publish_class_t *publish_class : class to report
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void publish_class_report(publish_class_t *publish_class)
+{
+    const publish_class_stats_t stats = publish_class->stats;
+    const uint32_t span_s = (uint32_t)((xTaskGetTickCount() - stats.start_tick) / configTICK_RATE_HZ);
+    publisher_data_t diag;
+
+    memset(&publish_class->stats, 0, sizeof(publish_class->stats));
+
+    printf("  Publisher: %s QoS %d, %lu messages in %lu s, %lu failed, publish avg %lu ms, max %lu ms\n\n",
+           publish_class->name, (int)publish_class->qos, (unsigned long)stats.count,
+           (unsigned long)span_s, (unsigned long)stats.failed,
+           (unsigned long)(stats.ms_sum / stats.count), (unsigned long)stats.ms_max);
+
+    diag.cmd = PUBLISH_MQTT_DIAG;
+    diag.seq = 0;
+    snprintf(diag.data, sizeof(diag.data),
+             "{\"class\":\"%s\",\"qos\":%d,\"n\":%lu,\"fail\":%lu,\"ms\":[%lu,%lu],\"s\":%lu}",
+             publish_class->name, (int)publish_class->qos, (unsigned long)stats.count,
+             (unsigned long)stats.failed, (unsigned long)(stats.ms_sum / stats.count),
+             (unsigned long)stats.ms_max, (unsigned long)span_s);
+    (void)publisher_post(&diag);
 }
 
 /* [] END OF FILE */
@@ -26,19 +26,44 @@
 
 #pragma once
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #include "FreeRTOS.h"
 #include "queue.h"
 #include "task.h"
+#include "mqtt_topic.h"
+#include "stack_size_config.h"
 
 /*******************************************************************************
  * Macros
  ******************************************************************************/
 /* Task parameters for Button Task. */
 #define PUBLISHER_TASK_PRIORITY   (2)
+#ifndef PUBLISHER_TASK_STACK_SIZE
 #define PUBLISHER_TASK_STACK_SIZE (1024 * 2)
+#endif
+
+/* Queue length of a message queue that is used to communicate with the
+ * publisher task.
+ */
+#define PUBLISHER_TASK_QUEUE_LENGTH (6u)
+
+/* Slots of the publisher queue that low priority messages leave free for
+ * telemetry and alerts.
+ */
+#define PUBLISHER_QUEUE_RESERVED_SLOTS (1u)
 
 #define MQTT_PUB_QUEUE_LENGTH (10u)
-#define MQTT_PUB_MSG_MAX_SIZE (64u)
+/* Longest payload including the terminating null, sized for the connection
+ * diagnostics that hold seven numbers.
+ */
+#define MQTT_PUB_MSG_MAX_SIZE (96u)
+
+/* The publish timing of each message class, except the diagnostics, is
+ * published on the diagnostics topic every this many messages of the class.
+ */
+#define PUBLISHER_CLASS_REPORT_COUNT (100u)
 /*******************************************************************************
  * Typedefines
  ******************************************************************************/
@@ -47,12 +72,34 @@ typedef enum
 {
     PUBLISHER_INIT,
     PUBLISHER_DEINIT,
-    PUBLISH_MQTT_MSG
+    PUBLISH_MQTT_MSG,
+    PUBLISH_MQTT_ALERT,
+    PUBLISH_MQTT_CONFIG_ACK,
+    PUBLISH_MQTT_DIAG
 } publisher_cmd_t;
 
-/* Struct to be passed via the publisher task queue */
+/* Publish descriptor of a message, filled by publisher_post() from the
+ * class of the command. It travels with the message through the queue and
+ * the redelivery ring, so no shared publish information is modified.
+ */
+typedef struct
+{
+    mqtt_topic_id_t topic;      /* Interned topic */
+    uint8_t qos;                /* QoS of the publish */
+    bool retain;                /* Retain flag of the publish */
+    uint16_t payload_len;       /* Length of 'data' without the null */
+} publish_desc_t;
+
+/* Struct to be passed via the publisher task queue. Telemetry and alerts
+ * carry a sequence number, which is also part of their payload. They are
+ * kept for the redelivery if the publish fails. Other messages use 0 and
+ * are not redelivered. The message owns its payload, it is copied with the
+ * message.
+ */
 typedef struct{
     publisher_cmd_t cmd;
+    uint32_t seq;
+    publish_desc_t desc;
     char data[MQTT_PUB_MSG_MAX_SIZE];
 } publisher_data_t;
 
@@ -66,5 +113,10 @@ extern QueueHandle_t publisher_task_q;
  * Function Prototypes
  ******************************************************************************/
 void publisher_task(void *pvParameters);
+void publisher_init(void);
+void publisher_handle(const publisher_data_t *publisher_q_data);
+BaseType_t publisher_post(publisher_data_t *message);
+TickType_t publisher_wait_ticks(void);
+void publisher_flush_step(void);
 
 /* [] END OF FILE */
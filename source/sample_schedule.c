@@ -0,0 +1,272 @@
+/******************************************************************************
+ * File Name:   sample_schedule.c
+ *
+ * Description: This file contains the periodic scheduler of the CO2 samples.
+ *              The samples are released on an absolute time grid instead of
+ *              sleeping one period after each sample, so the sample rate does
+ *              not drift. A release that is missed by more than a period is
+ *              skipped instead of being made up with back-to-back samples.
+ *              Optionally, the grid is aligned to multiples of the period in
+ *              UTC, so that the samples of many devices fall on the same
+ *              time buckets.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#include "cy_utils.h"
+
+#include "sample_schedule.h"
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+static uint32_t sample_schedule_skip(sample_schedule_t *schedule, uint64_t now_ms);
+static void sample_schedule_snap(sample_schedule_t *schedule, uint64_t now_ms, uint64_t utc_ms);
+
+/*******************************************************************************
+ * Function Name: sample_schedule_init
+ *******************************************************************************
+ * Summary:
+ *   Resets the scheduler and its metrics. The first sample is released one
+ *   period from now.
+ *
+ * Parameters:
+ *   schedule: scheduler state
+ *   period_ms: sample period in milliseconds, must not be zero
+ *   now_ms: current monotonic time in milliseconds
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void sample_schedule_init(sample_schedule_t *schedule, uint32_t period_ms, uint64_t now_ms)
+{
+    CY_ASSERT(period_ms != 0U);
+
+    *schedule = (sample_schedule_t){
+        .next_ms = now_ms + period_ms,
+        .target_ms = now_ms + period_ms,
+        .period_ms = period_ms
+    };
+}
+
+/*******************************************************************************
+ * Function Name: sample_schedule_align
+ *******************************************************************************
+ * Summary:
+ *   Enables or disables the alignment of the grid to UTC. When enabled, the
+ *   grid points are moved to 'phase_ms' after the UTC multiples of the
+ *   period, e.g. 2.5 s after :00, :10, :20 s with a period of 10 s. The
+ *   alignment starts with the first release once UTC is known.
+ *
+ * Parameters:
+ *   schedule: scheduler state
+ *   aligned: true to align the grid to UTC
+ *   phase_ms: offset of the grid points after the UTC boundaries. Reduced
+ *             modulo the period when the grid is aligned.
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void sample_schedule_align(sample_schedule_t *schedule, bool aligned, uint32_t phase_ms)
+{
+    schedule->aligned = aligned;
+    schedule->phase_ms = phase_ms;
+}
+
+/*******************************************************************************
+ * Function Name: sample_schedule_restart
+ *******************************************************************************
+ * Summary:
+ *   Moves the grid so that the next sample is released one period from now,
+ *   e.g. after the sensor restarted its measurement. The metrics are kept.
+ *
+ * Parameters:
+ *   schedule: scheduler state
+ *   period_ms: sample period in milliseconds, must not be zero
+ *   now_ms: current monotonic time in milliseconds
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void sample_schedule_restart(sample_schedule_t *schedule, uint32_t period_ms, uint64_t now_ms)
+{
+    CY_ASSERT(period_ms != 0U);
+
+    schedule->period_ms = period_ms;
+    schedule->next_ms = now_ms + period_ms;
+    schedule->target_ms = schedule->next_ms;
+}
+
+/*******************************************************************************
+ * Function Name: sample_schedule_delay_ms
+ *******************************************************************************
+ * Summary:
+ *   Returns the time to wait until the next release. A new period takes
+ *   effect from the last release, so the grid keeps its phase. If the next
+ *   release was already missed, the missed grid points are skipped. They
+ *   count as overruns unless the period was just shortened. In the aligned
+ *   mode, the release is then moved to the closest UTC grid point.
+ *
+ * Parameters:
+ *   schedule: scheduler state
+ *   period_ms: sample period in milliseconds, must not be zero
+ *   offset_ms: delay of this release after its grid point, e.g. a random
+ *              jitter. It does not move the grid.
+ *   now_ms: current monotonic time in milliseconds
+ *   utc_ms: current UTC time in milliseconds, 0 if not known
+ *
+ * Return:
+ *   uint32_t: time to wait in milliseconds
+ ******************************************************************************/
+uint32_t sample_schedule_delay_ms(sample_schedule_t *schedule, uint32_t period_ms, uint32_t offset_ms,
+                                  uint64_t now_ms, uint64_t utc_ms)
+{
+    CY_ASSERT(period_ms != 0U);
+
+    if (period_ms != schedule->period_ms)
+    {
+        schedule->next_ms = schedule->next_ms - schedule->period_ms + period_ms;
+        schedule->period_ms = period_ms;
+        (void)sample_schedule_skip(schedule, now_ms);
+    }
+
+    schedule->overrun_count += sample_schedule_skip(schedule, now_ms);
+
+    schedule->target_utc_ms = 0;
+    if (schedule->aligned && (utc_ms != 0u))
+    {
+        sample_schedule_snap(schedule, now_ms, utc_ms);
+    }
+
+    schedule->target_ms = schedule->next_ms + offset_ms;
+    if (schedule->target_utc_ms != 0u)
+    {
+        schedule->target_utc_ms += offset_ms;
+    }
+
+    return (uint32_t)(schedule->target_ms - now_ms);
+}
+
+/*******************************************************************************
+ * Function Name: sample_schedule_release
+ *******************************************************************************
+ * Summary:
+ *   Records the release of a sample and advances the grid by one period.
+ *   The delay of the release after its target time is the jitter. On the
+ *   UTC grid, the distance of the UTC time of the release to its grid point
+ *   is the alignment error. It also includes the UTC corrections made while
+ *   waiting.
+ *
+ * Parameters:
+ *   schedule: scheduler state
+ *   now_ms: current monotonic time in milliseconds
+ *   utc_ms: current UTC time in milliseconds, 0 if not known
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void sample_schedule_release(sample_schedule_t *schedule, uint64_t now_ms, uint64_t utc_ms)
+{
+    const uint32_t jitter_ms = (now_ms > schedule->target_ms) ? (uint32_t)(now_ms - schedule->target_ms) : 0u;
+
+    schedule->sample_count++;
+    schedule->jitter_sum_ms += jitter_ms;
+    if (jitter_ms > schedule->jitter_max_ms)
+    {
+        schedule->jitter_max_ms = jitter_ms;
+    }
+
+    if ((schedule->target_utc_ms != 0u) && (utc_ms != 0u))
+    {
+        const uint32_t align_ms = (utc_ms > schedule->target_utc_ms) ?
+                                  (uint32_t)(utc_ms - schedule->target_utc_ms) :
+                                  (uint32_t)(schedule->target_utc_ms - utc_ms);
+
+        schedule->align_count++;
+        schedule->align_sum_ms += align_ms;
+        if (align_ms > schedule->align_max_ms)
+        {
+            schedule->align_max_ms = align_ms;
+        }
+    }
+
+    schedule->next_ms += schedule->period_ms;
+}
+
+/*******************************************************************************
+ * Function Name: sample_schedule_skip
+ *******************************************************************************
+ * Summary:
+ *   Advances the next release past the current time, in whole periods.
+ *
+ * Parameters:
+ *   schedule: scheduler state
+ *   now_ms: current monotonic time in milliseconds
+ *
+ * Return:
+ *   uint32_t: number of grid points skipped
+ ******************************************************************************/
+static uint32_t sample_schedule_skip(sample_schedule_t *schedule, uint64_t now_ms)
+{
+    uint64_t missed = 0;
+
+    if (now_ms > schedule->next_ms)
+    {
+        missed = ((now_ms - schedule->next_ms) / schedule->period_ms) + 1u;
+        schedule->next_ms += missed * schedule->period_ms;
+    }
+
+    return (uint32_t)missed;
+}
+
+/*******************************************************************************
+ * Function Name: sample_schedule_snap
+ *******************************************************************************
+ * Summary:
+ *   Moves the next release to the UTC grid point closest to it, but not in
+ *   the past. The grid is snapped again before every release, so that UTC
+ *   corrections and drift of the monotonic clock do not add up.
+ *
+ * Parameters:
+ *   schedule: scheduler state, 'next_ms' must not be in the past
+ *   now_ms: current monotonic time in milliseconds
+ *   utc_ms: current UTC time in milliseconds, not 0
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void sample_schedule_snap(sample_schedule_t *schedule, uint64_t now_ms, uint64_t utc_ms)
+{
+    const uint64_t period_ms = schedule->period_ms;
+    const uint64_t phase_ms = schedule->phase_ms % period_ms;
+    const uint64_t next_utc_ms = utc_ms + (schedule->next_ms - now_ms);
+    uint64_t grid_utc_ms = (((next_utc_ms + (period_ms / 2u) - phase_ms) / period_ms) * period_ms) + phase_ms;
+
+    if (grid_utc_ms < utc_ms)
+    {
+        grid_utc_ms += period_ms;
+    }
+
+    schedule->next_ms = now_ms + (grid_utc_ms - utc_ms);
+    schedule->target_utc_ms = grid_utc_ms;
+}
+
+/* [] END OF FILE */
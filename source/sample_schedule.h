@@ -0,0 +1,71 @@
+/******************************************************************************
+ * File Name:   sample_schedule.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *              in sample_schedule.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Typedefines
+ ******************************************************************************/
+/* State of the periodic sample scheduler. The release times are kept on an
+ * absolute grid of the monotonic time, so the time spent reading and
+ * publishing a sample does not shift the following samples.
+ */
+typedef struct
+{
+    uint64_t next_ms;           /* Next release time on the grid */
+    uint64_t target_ms;         /* Next release time including the offset */
+    uint32_t period_ms;         /* Distance of the grid points */
+
+    /* Alignment of the grid to UTC, see sample_schedule_align() */
+    bool aligned;               /* True to align the grid once UTC is known */
+    uint32_t phase_ms;          /* Offset of the grid points after the UTC boundaries */
+    uint64_t target_utc_ms;     /* UTC time of the next release, 0 if not aligned */
+
+    /* Metrics since the scheduler was started */
+    uint32_t sample_count;      /* Samples released */
+    uint32_t overrun_count;     /* Grid points skipped after an overrun */
+    uint32_t jitter_max_ms;     /* Largest delay of a release */
+    uint64_t jitter_sum_ms;     /* Sum of the release delays */
+    uint32_t align_count;       /* Releases made on the UTC grid */
+    uint32_t align_max_ms;      /* Largest UTC alignment error */
+    uint64_t align_sum_ms;      /* Sum of the UTC alignment errors */
+} sample_schedule_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+void sample_schedule_init(sample_schedule_t *schedule, uint32_t period_ms, uint64_t now_ms);
+void sample_schedule_align(sample_schedule_t *schedule, bool aligned, uint32_t phase_ms);
+void sample_schedule_restart(sample_schedule_t *schedule, uint32_t period_ms, uint64_t now_ms);
+uint32_t sample_schedule_delay_ms(sample_schedule_t *schedule, uint32_t period_ms, uint32_t offset_ms,
+                                  uint64_t now_ms, uint64_t utc_ms);
+void sample_schedule_release(sample_schedule_t *schedule, uint64_t now_ms, uint64_t utc_ms);
+
+/* [] END OF FILE */
@@ -0,0 +1,177 @@
+/******************************************************************************
+ * File Name:   sensor_trace.c
+ *
+ * Description: This file contains the recorder and the replay driver of raw
+ *              sensor reads. Recorded traces are dumped over the serial
+ *              terminal and compiled back into the application, so that
+ *              reporting and filtering can be tuned with repeatable input.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sensor_trace.h"
+
+/*******************************************************************************
+ * External Variables
+ ******************************************************************************/
+/* Trace compiled into the application for replay, see sensor_trace_data.c */
+extern const uint8_t sensor_trace_replay_data[];
+extern const uint32_t sensor_trace_replay_size;
+
+/*******************************************************************************
+ * Local Variables
+ ******************************************************************************/
+#if (SENSOR_TRACE_RECORD_ENABLED != 0)
+/* Ring of the latest records, 'trace_count' saturates at the capacity */
+static sensor_trace_record_t trace_ring[SENSOR_TRACE_CAPACITY];
+static uint32_t trace_head = 0;
+static uint32_t trace_count = 0;
+#endif
+
+/* Replay position and virtual time of the last replayed record */
+static uint32_t replay_index = 0;
+static uint64_t replay_virtual_ms = 0;
+static uint32_t replay_last_time_ms = 0;
+static uint32_t replay_last_delta_ms = 0;
+static bool replay_started = false;
+
+/*******************************************************************************
+ * Function Name: sensor_trace_record
+ *******************************************************************************
+ * Summary:
+ *   Stores a sensor read in the ring, overwriting the oldest record when the
+ *   ring is full. The caller must hold 'sem_pasco2_context'.
+ *
+ * Parameters:
+ *   record: sensor read to store
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void sensor_trace_record(const sensor_trace_record_t *record)
+{
+#if (SENSOR_TRACE_RECORD_ENABLED != 0)
+    trace_ring[trace_head] = *record;
+    trace_head = (trace_head + 1U) % SENSOR_TRACE_CAPACITY;
+    if (trace_count < SENSOR_TRACE_CAPACITY)
+    {
+        trace_count++;
+    }
+#else
+    (void)record;
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: sensor_trace_dump
+ *******************************************************************************
+ * Summary:
+ *   Prints the recorded sensor reads from oldest to newest as hex lines
+ *   between two marker lines. The lines between the markers convert to the
+ *   binary trace with 'xxd -r -p'. The caller must hold
+ *   'sem_pasco2_context'.
+ *
+ * Parameters:
+ *   void
+ *
+ * Return:
+ *   uint32_t: number of records printed
+ ******************************************************************************/
+uint32_t sensor_trace_dump(void)
+{
+#if (SENSOR_TRACE_RECORD_ENABLED != 0)
+    uint32_t index = (trace_head + SENSOR_TRACE_CAPACITY - trace_count) % SENSOR_TRACE_CAPACITY;
+
+    printf("-----BEGIN SENSOR TRACE-----\n");
+    for (uint32_t i = 0; i < trace_count; i++)
+    {
+        const uint8_t *bytes = (const uint8_t *)&trace_ring[index];
+        for (uint32_t j = 0; j < sizeof(sensor_trace_record_t); j++)
+        {
+            printf("%02x", bytes[j]);
+        }
+        printf("\n");
+        index = (index + 1U) % SENSOR_TRACE_CAPACITY;
+    }
+    printf("-----END SENSOR TRACE-----\n");
+
+    return trace_count;
+#else
+    return 0;
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: sensor_trace_replay_next
+ *******************************************************************************
+ * Summary:
+ *   Returns the next record of the compiled-in trace and restarts at the
+ *   first record after the last one. The virtual time advances by the
+ *   recorded time between two reads, independent of the real time, so the
+ *   time-based detectors see the recorded timing at any replay speed.
+ *
+ * Parameters:
+ *   record: next recorded sensor read
+ *
+ * Return:
+ *   uint64_t: virtual monotonic time of the record in milliseconds
+ ******************************************************************************/
+uint64_t sensor_trace_replay_next(sensor_trace_record_t *record)
+{
+    const uint32_t record_count = sensor_trace_replay_size / sizeof(sensor_trace_record_t);
+
+    if (record_count == 0U)
+    {
+        memset(record, 0, sizeof(*record));
+        return replay_virtual_ms;
+    }
+
+    if (replay_index >= record_count)
+    {
+        printf("Sensor trace replay restarted\n");
+        replay_index = 0;
+    }
+
+    memcpy(record, &sensor_trace_replay_data[replay_index * sizeof(sensor_trace_record_t)], sizeof(*record));
+
+    /* Keep the previous step across the restart, the gap between the last
+     * and the first record is not part of the recording.
+     */
+    if (!replay_started)
+    {
+        replay_started = true;
+    }
+    else if (replay_index != 0U)
+    {
+        replay_last_delta_ms = record->time_ms - replay_last_time_ms;
+    }
+    replay_virtual_ms += replay_last_delta_ms;
+    replay_last_time_ms = record->time_ms;
+    replay_index++;
+
+    return replay_virtual_ms;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,71 @@
+/******************************************************************************
+ * File Name:   sensor_trace.h
+ *
+ * Description: This file is the public interface of sensor_trace.c
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Set to 1 to record every sensor read into a RAM ring that can be dumped
+ * over the serial terminal with the 'pasco2_trace_dump' configuration key.
+ */
+#ifndef SENSOR_TRACE_RECORD_ENABLED
+#define SENSOR_TRACE_RECORD_ENABLED  (0)
+#endif
+
+/* Number of records kept in the ring, each record takes 12 bytes of RAM */
+#define SENSOR_TRACE_CAPACITY        (512U)
+
+/* Temperature value of records taken without a DPS3xx sensor */
+#define SENSOR_TRACE_TEMPERATURE_UNKNOWN (INT16_MIN)
+
+/*******************************************************************************
+ * Typedefines
+ ******************************************************************************/
+/* One sensor read. The layout has no padding, so a dump of the ring is a
+ * compact little-endian binary file that can be replayed as is.
+ */
+typedef struct
+{
+    uint32_t time_ms;               /* Monotonic time of the read */
+    uint16_t ppm;                   /* CO2 value */
+    uint16_t pressure_hpa_x10;      /* Pressure used for compensation */
+    int16_t temperature_c_x100;     /* DPS3xx temperature */
+    uint8_t status;                 /* Last PAS CO2 status register value */
+    uint8_t result;                 /* Result code of the CO2 read, 0 if ok */
+} sensor_trace_record_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+void sensor_trace_record(const sensor_trace_record_t *record);
+uint32_t sensor_trace_dump(void);
+uint64_t sensor_trace_replay_next(sensor_trace_record_t *record);
+
+/* [] END OF FILE */
@@ -0,0 +1,102 @@
+/******************************************************************************
+ * File Name:   sensor_trace_data.c
+ *
+ * Description: This file contains the sensor trace replayed when the
+ *              application is built with CO2_SOURCE=REPLAY. Replace the
+ *              array with a recorded trace, see README.md.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#include <stdint.h>
+
+/* Example trace of 64 reads taken once per minute, as generated by
+ * 'xxd -i' from a binary trace. Each line is one 12-byte record.
+ */
+const uint8_t sensor_trace_replay_data[] = {
+    0x00, 0x00, 0x00, 0x00, 0xf6, 0x01, 0xa6, 0x27, 0xca, 0x08, 0x00, 0x00,
+    0x60, 0xea, 0x00, 0x00, 0x42, 0x02, 0xa7, 0x27, 0xcb, 0x08, 0x00, 0x00,
+    0xc0, 0xd4, 0x01, 0x00, 0x8d, 0x02, 0xa8, 0x27, 0xcc, 0x08, 0x00, 0x00,
+    0x20, 0xbf, 0x02, 0x00, 0xd7, 0x02, 0xa9, 0x27, 0xcd, 0x08, 0x00, 0x00,
+    0x80, 0xa9, 0x03, 0x00, 0x1f, 0x03, 0xaa, 0x27, 0xce, 0x08, 0x00, 0x00,
+    0xe0, 0x93, 0x04, 0x00, 0x60, 0x03, 0xa6, 0x27, 0xcf, 0x08, 0x00, 0x00,
+    0x40, 0x7e, 0x05, 0x00, 0xa4, 0x03, 0xa7, 0x27, 0xd0, 0x08, 0x00, 0x00,
+    0xa0, 0x68, 0x06, 0x00, 0xdd, 0x03, 0xa8, 0x27, 0xd1, 0x08, 0x00, 0x00,
+    0x00, 0x53, 0x07, 0x00, 0x1c, 0x04, 0xa9, 0x27, 0xd2, 0x08, 0x00, 0x00,
+    0x60, 0x3d, 0x08, 0x00, 0x55, 0x04, 0xaa, 0x27, 0xd3, 0x08, 0x00, 0x00,
+    0xc0, 0x27, 0x09, 0x00, 0x8a, 0x04, 0xa6, 0x27, 0xd4, 0x08, 0x00, 0x00,
+    0x20, 0x12, 0x0a, 0x00, 0xc6, 0x04, 0xa7, 0x27, 0xd5, 0x08, 0x00, 0x00,
+    0x80, 0xfc, 0x0a, 0x00, 0xfb, 0x04, 0xa8, 0x27, 0xd6, 0x08, 0x00, 0x00,
+    0xe0, 0xe6, 0x0b, 0x00, 0x30, 0x05, 0xa9, 0x27, 0xd7, 0x08, 0x00, 0x00,
+    0x40, 0xd1, 0x0c, 0x00, 0x5c, 0x05, 0xaa, 0x27, 0xd8, 0x08, 0x00, 0x00,
+    0xa0, 0xbb, 0x0d, 0x00, 0x92, 0x05, 0xa6, 0x27, 0xd9, 0x08, 0x00, 0x00,
+    0x00, 0xa6, 0x0e, 0x00, 0xc0, 0x05, 0xa7, 0x27, 0xda, 0x08, 0x00, 0x00,
+    0x60, 0x90, 0x0f, 0x00, 0xef, 0x05, 0xa8, 0x27, 0xdb, 0x08, 0x00, 0x00,
+    0xc0, 0x7a, 0x10, 0x00, 0x16, 0x06, 0xa9, 0x27, 0xdc, 0x08, 0x00, 0x00,
+    0x20, 0x65, 0x11, 0x00, 0x46, 0x06, 0xaa, 0x27, 0xdd, 0x08, 0x00, 0x00,
+    0x80, 0x4f, 0x12, 0x00, 0x6b, 0x06, 0xa6, 0x27, 0xde, 0x08, 0x00, 0x00,
+    0xe0, 0x39, 0x13, 0x00, 0x97, 0x06, 0xa7, 0x27, 0xdf, 0x08, 0x00, 0x00,
+    0x40, 0x24, 0x14, 0x00, 0xbb, 0x06, 0xa8, 0x27, 0xe0, 0x08, 0x00, 0x00,
+    0xa0, 0x0e, 0x15, 0x00, 0xdc, 0x06, 0xa9, 0x27, 0xe1, 0x08, 0x00, 0x00,
+    0x00, 0xf9, 0x15, 0x00, 0xad, 0x06, 0xaa, 0x27, 0xe2, 0x08, 0x00, 0x00,
+    0x60, 0xe3, 0x16, 0x00, 0x88, 0x06, 0xa6, 0x27, 0xe3, 0x08, 0x00, 0x00,
+    0xc0, 0xcd, 0x17, 0x00, 0x57, 0x06, 0xa7, 0x27, 0xe4, 0x08, 0x00, 0x00,
+    0x20, 0xb8, 0x18, 0x00, 0x38, 0x06, 0xa8, 0x27, 0xe5, 0x08, 0x00, 0x00,
+    0x80, 0xa2, 0x19, 0x00, 0x07, 0x06, 0xa9, 0x27, 0xe6, 0x08, 0x00, 0x00,
+    0xe0, 0x8c, 0x1a, 0x00, 0xe4, 0x05, 0xaa, 0x27, 0xe7, 0x08, 0x00, 0x00,
+    0x40, 0x77, 0x1b, 0x00, 0xc4, 0x05, 0xa6, 0x27, 0xe8, 0x08, 0x00, 0x00,
+    0xa0, 0x61, 0x1c, 0x00, 0xa3, 0x05, 0xa7, 0x27, 0xe9, 0x08, 0x00, 0x00,
+    0x00, 0x4c, 0x1d, 0x00, 0x82, 0x05, 0xa8, 0x27, 0xea, 0x08, 0x00, 0x00,
+    0x60, 0x36, 0x1e, 0x00, 0x58, 0x05, 0xa9, 0x27, 0xeb, 0x08, 0x00, 0x00,
+    0xc0, 0x20, 0x1f, 0x00, 0x38, 0x05, 0xaa, 0x27, 0xec, 0x08, 0x00, 0x00,
+    0x20, 0x0b, 0x20, 0x00, 0x20, 0x05, 0xa6, 0x27, 0xed, 0x08, 0x00, 0x00,
+    0x80, 0xf5, 0x20, 0x00, 0x01, 0x05, 0xa7, 0x27, 0xee, 0x08, 0x00, 0x00,
+    0xe0, 0xdf, 0x21, 0x00, 0xe2, 0x04, 0xa8, 0x27, 0xef, 0x08, 0x00, 0x00,
+    0x40, 0xca, 0x22, 0x00, 0xc5, 0x04, 0xa9, 0x27, 0xf0, 0x08, 0x00, 0x00,
+    0xa0, 0xb4, 0x23, 0x00, 0xa9, 0x04, 0xaa, 0x27, 0xf1, 0x08, 0x00, 0x00,
+    0x00, 0x9f, 0x24, 0x00, 0x93, 0x04, 0xa6, 0x27, 0xf2, 0x08, 0x00, 0x00,
+    0x60, 0x89, 0x25, 0x00, 0x7a, 0x04, 0xa7, 0x27, 0xf3, 0x08, 0x00, 0x00,
+    0xc0, 0x73, 0x26, 0x00, 0x66, 0x04, 0xa8, 0x27, 0xf4, 0x08, 0x00, 0x00,
+    0x20, 0x5e, 0x27, 0x00, 0x4b, 0x04, 0xa9, 0x27, 0xf5, 0x08, 0x00, 0x00,
+    0x80, 0x48, 0x28, 0x00, 0x33, 0x04, 0xaa, 0x27, 0xf6, 0x08, 0x00, 0x00,
+    0xe0, 0x32, 0x29, 0x00, 0x20, 0x04, 0xa6, 0x27, 0xf7, 0x08, 0x00, 0x00,
+    0x40, 0x1d, 0x2a, 0x00, 0x04, 0x04, 0xa7, 0x27, 0xf8, 0x08, 0x00, 0x00,
+    0xa0, 0x07, 0x2b, 0x00, 0xf6, 0x03, 0xa8, 0x27, 0xf9, 0x08, 0x00, 0x00,
+    0x00, 0xf2, 0x2b, 0x00, 0xe4, 0x03, 0xa9, 0x27, 0xfa, 0x08, 0x00, 0x00,
+    0x60, 0xdc, 0x2c, 0x00, 0xcb, 0x03, 0xaa, 0x27, 0xfb, 0x08, 0x00, 0x00,
+    0xc0, 0xc6, 0x2d, 0x00, 0xbc, 0x03, 0xa6, 0x27, 0xfc, 0x08, 0x00, 0x00,
+    0x20, 0xb1, 0x2e, 0x00, 0xaa, 0x03, 0xa7, 0x27, 0xfd, 0x08, 0x00, 0x00,
+    0x80, 0x9b, 0x2f, 0x00, 0x96, 0x03, 0xa8, 0x27, 0xfe, 0x08, 0x00, 0x00,
+    0xe0, 0x85, 0x30, 0x00, 0x89, 0x03, 0xa9, 0x27, 0xff, 0x08, 0x00, 0x00,
+    0x40, 0x70, 0x31, 0x00, 0x7a, 0x03, 0xaa, 0x27, 0x00, 0x09, 0x00, 0x00,
+    0xa0, 0x5a, 0x32, 0x00, 0x6d, 0x03, 0xa6, 0x27, 0x01, 0x09, 0x00, 0x00,
+    0x00, 0x45, 0x33, 0x00, 0x58, 0x03, 0xa7, 0x27, 0x02, 0x09, 0x00, 0x00,
+    0x60, 0x2f, 0x34, 0x00, 0x4f, 0x03, 0xa8, 0x27, 0x03, 0x09, 0x00, 0x00,
+    0xc0, 0x19, 0x35, 0x00, 0x3b, 0x03, 0xa9, 0x27, 0x04, 0x09, 0x00, 0x00,
+    0x20, 0x04, 0x36, 0x00, 0x2b, 0x03, 0xaa, 0x27, 0x05, 0x09, 0x00, 0x00,
+    0x80, 0xee, 0x36, 0x00, 0x20, 0x03, 0xa6, 0x27, 0x06, 0x09, 0x00, 0x00,
+    0xe0, 0xd8, 0x37, 0x00, 0x11, 0x03, 0xa7, 0x27, 0x07, 0x09, 0x00, 0x00,
+    0x40, 0xc3, 0x38, 0x00, 0x0b, 0x03, 0xa8, 0x27, 0x08, 0x09, 0x00, 0x00,
+    0xa0, 0xad, 0x39, 0x00, 0xff, 0x02, 0xa9, 0x27, 0x09, 0x09, 0x00, 0x00
+};
+const uint32_t sensor_trace_replay_size = sizeof(sensor_trace_replay_data);
+
+/* [] END OF FILE */
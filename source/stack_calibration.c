@@ -0,0 +1,306 @@
+/******************************************************************************
+ * File Name:   stack_calibration.c
+ *
+ * Description: This file contains the stack size calibration. The worst-case
+ *              paths of the application are driven once after the first MQTT
+ *              connection: a configuration message of the maximum size with
+ *              error values, and a reconnection to the broker including the
+ *              TLS handshake. The stack high-water marks of the application
+ *              tasks are then printed periodically as calibrated stack sizes
+ *              with a safety margin, ready to be copied into
+ *              configs/stack_size_config.h.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS header files */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "stack_calibration.h"
+
+#if (STACK_CALIBRATION_ENABLED != 0)
+
+#include "app_alloc.h"
+#include "app_event_loop.h"
+#include "mqtt_event_ring.h"
+#include "mqtt_task.h"
+#include "pasco2_config_task.h"
+#include "pasco2_task.h"
+#include "publisher_task.h"
+#include "subscriber_task.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define CALIBRATED_TASK_COUNT   (sizeof(calibrated_tasks) / sizeof(calibrated_tasks[0]))
+
+/* Interval in milliseconds to check the connection state during the
+ * reconnection.
+ */
+#define RECONNECT_POLL_MS       (500u)
+
+/*******************************************************************************
+ * Typedefines
+ ******************************************************************************/
+/* Task whose stack size is calibrated */
+typedef struct
+{
+    const char *macro;          /* Name of the stack size macro */
+    TaskHandle_t *handle;       /* Handle of the task, NULL before creation */
+    uint32_t size;              /* Stack size of this build in words */
+} calibrated_task_t;
+
+/*******************************************************************************
+ * Local Variables
+ ******************************************************************************/
+static TaskHandle_t stack_calibration_task_handle = NULL;
+APP_TASK_MEMORY(stack_calibration_task, STACK_CALIBRATION_TASK_STACK_SIZE);
+
+static const calibrated_task_t calibrated_tasks[] =
+{
+    { "MQTT_CLIENT_TASK_STACK_SIZE",    &mqtt_client_task_handle,       MQTT_CLIENT_TASK_STACK_SIZE },
+#if (APP_EVENT_LOOP_ENABLED != 0)
+    { "APP_EVENT_LOOP_TASK_STACK_SIZE", &app_event_loop_task_handle,    APP_EVENT_LOOP_TASK_STACK_SIZE },
+#else
+    { "SUBSCRIBER_TASK_STACK_SIZE",     &subscriber_task_handle,        SUBSCRIBER_TASK_STACK_SIZE },
+    { "PUBLISHER_TASK_STACK_SIZE",      &publisher_task_handle,         PUBLISHER_TASK_STACK_SIZE },
+    { "PASCO2_CONFIG_TASK_STACK_SIZE",  &pasco2_config_task_handle,     PASCO2_CONFIG_TASK_STACK_SIZE },
+#endif
+    { "PASCO2_TASK_STACK_SIZE",         &pasco2_task_handle,            PASCO2_TASK_STACK_SIZE },
+};
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+static void stack_calibration_task(void *pvParameters);
+static void drive_config_payload(void);
+static void drive_reconnect(void);
+static void print_stack_sizes(void);
+
+/*******************************************************************************
+ * Function Name: stack_calibration_start
+ *******************************************************************************
+ * Summary:
+ *   Creates the task that runs the stack size calibration. Called once after
+ *   the first MQTT connection.
+ *
+ * Parameters:
+ *   void
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void stack_calibration_start(void)
+{
+    if (pdPASS != APP_TASK_CREATE(stack_calibration_task, STACK_CALIBRATION_TASK_NAME,
+                                  STACK_CALIBRATION_TASK_STACK_SIZE, NULL,
+                                  STACK_CALIBRATION_TASK_PRIORITY, &stack_calibration_task_handle))
+    {
+        printf("Failed to create '%s' task!\n", STACK_CALIBRATION_TASK_NAME);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: stack_calibration_stop
+ *******************************************************************************
+ * Summary:
+ *   Deletes the calibration task. Called by the MQTT client task before it
+ *   deletes the application tasks, whose handles the calibration reads.
+ *
+ * Parameters:
+ *   void
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void stack_calibration_stop(void)
+{
+    if (stack_calibration_task_handle != NULL)
+    {
+        vTaskDelete(stack_calibration_task_handle);
+        stack_calibration_task_handle = NULL;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: stack_calibration_task
+ *******************************************************************************
+ * Summary:
+ *   Drives the worst-case paths once and then prints the calibrated stack
+ *   sizes periodically.
+ *
+ * Parameters:
+ *   pvParameters: task parameter (unused)
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void stack_calibration_task(void *pvParameters)
+{
+    (void)pvParameters;
+
+    vTaskDelay(pdMS_TO_TICKS(STACK_CALIBRATION_START_DELAY_MS));
+
+    drive_config_payload();
+    vTaskDelay(pdMS_TO_TICKS(STACK_CALIBRATION_START_DELAY_MS));
+
+    drive_reconnect();
+    vTaskDelay(pdMS_TO_TICKS(STACK_CALIBRATION_START_DELAY_MS));
+
+    while (true)
+    {
+        print_stack_sizes();
+        vTaskDelay(pdMS_TO_TICKS(STACK_CALIBRATION_REPORT_INTERVAL_MS));
+    }
+}
+
+/*******************************************************************************
+ * Function Name: drive_config_payload
+ *******************************************************************************
+ * Summary:
+ *   Passes a configuration message of the maximum size to the subscriber
+ *   path, as if it was received from the broker. All values are out of range
+ *   and the message is padded with an unknown key, so the error paths run
+ *   and the sensor configuration is not changed. The read and the trace dump
+ *   requests only trigger an additional measurement and a printout.
+ *
+ * Parameters:
+ *   void
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void drive_config_payload(void)
+{
+    static const char head[] = "{\"pasco2_measurement_period\": 1, \"pasco2_burst\": 1, "
+                               "\"pasco2_read_now\": 1, \"pasco2_trace_dump\": 1, \"";
+    static const char tail[] = "\": 0}";
+    const size_t padding = sizeof(sub_msg_payload) - sizeof(head) - sizeof(tail) + 1u;
+
+    printf("Stack calibration: %u byte configuration message\n",
+           (unsigned int)(sizeof(sub_msg_payload) - 1u));
+
+    if (xSemaphoreTake(sem_sub_payload, portMAX_DELAY) == pdTRUE)
+    {
+        memcpy(sub_msg_payload, head, sizeof(head) - 1u);
+        memset(&sub_msg_payload[sizeof(head) - 1u], 'x', padding);
+        memcpy(&sub_msg_payload[sizeof(head) - 1u + padding], tail, sizeof(tail));
+        xSemaphoreGive(sem_sub_payload);
+    }
+
+    pasco2_config_request();
+}
+
+/*******************************************************************************
+ * Function Name: drive_reconnect
+ *******************************************************************************
+ * Summary:
+ *   Drops the MQTT connection and waits until the MQTT client task has
+ *   reconnected, which runs the DNS lookup, the TLS handshake and the
+ *   subscription again.
+ *
+ * Parameters:
+ *   void
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void drive_reconnect(void)
+{
+    const TickType_t start_tick = xTaskGetTickCount();
+    bool disconnected = false;
+
+    printf("Stack calibration: reconnecting to the broker\n");
+
+    /* Same command the MQTT event callback sends on a lost broker */
+    (void)mqtt_event_post(HANDLE_DISCONNECTION);
+
+    while ((xTaskGetTickCount() - start_tick) < pdMS_TO_TICKS(STACK_CALIBRATION_RECONNECT_TIMEOUT_MS))
+    {
+        if (conn_state != CONN_STATE_CONNECTED)
+        {
+            disconnected = true;
+        }
+        else if (disconnected)
+        {
+            printf("Stack calibration: reconnected\n");
+            return;
+        }
+        vTaskDelay(pdMS_TO_TICKS(RECONNECT_POLL_MS));
+    }
+
+    printf("Stack calibration: no reconnection within %u ms\n",
+           (unsigned int)STACK_CALIBRATION_RECONNECT_TIMEOUT_MS);
+}
+
+/*******************************************************************************
+ * Function Name: print_stack_sizes
+ *******************************************************************************
+ * Summary:
+ *   Prints the calibrated stack sizes as the macros of
+ *   configs/stack_size_config.h. Each size is the stack use measured since
+ *   the task was created plus STACK_CALIBRATION_MARGIN_PERCENT, rounded up to
+ *   STACK_CALIBRATION_ROUND_WORDS.
+ *
+ * Parameters:
+ *   void
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void print_stack_sizes(void)
+{
+    printf("\n/* Calibrated stack sizes in words, %u s after boot */\n",
+           (unsigned int)(xTaskGetTickCount() / configTICK_RATE_HZ));
+
+    for (uint32_t index = 0; index < CALIBRATED_TASK_COUNT; index++)
+    {
+        const calibrated_task_t *task = &calibrated_tasks[index];
+        uint32_t used;
+        uint32_t calibrated;
+
+        if (*task->handle == NULL)
+        {
+            continue;
+        }
+
+        used = task->size - (uint32_t)uxTaskGetStackHighWaterMark(*task->handle);
+        calibrated = (used * (100u + STACK_CALIBRATION_MARGIN_PERCENT) + 99u) / 100u;
+        calibrated = ((calibrated + STACK_CALIBRATION_ROUND_WORDS - 1u) / STACK_CALIBRATION_ROUND_WORDS) *
+                     STACK_CALIBRATION_ROUND_WORDS;
+        if (calibrated < configMINIMAL_STACK_SIZE)
+        {
+            calibrated = configMINIMAL_STACK_SIZE;
+        }
+
+        printf("#define %-32s (%u) /* %u of %u words used */\n", task->macro,
+               (unsigned int)calibrated, (unsigned int)used, (unsigned int)task->size);
+    }
+    printf("\n");
+}
+
+#endif /* STACK_CALIBRATION_ENABLED */
+
+/* [] END OF FILE */
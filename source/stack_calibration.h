@@ -0,0 +1,51 @@
+/******************************************************************************
+ * File Name:   stack_calibration.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *              in stack_calibration.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+#include "stack_size_config.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define STACK_CALIBRATION_TASK_NAME       "STACK CALIBRATION TASK"
+#define STACK_CALIBRATION_TASK_PRIORITY   (1)
+#define STACK_CALIBRATION_TASK_STACK_SIZE (1024 * 1)
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+#if (STACK_CALIBRATION_ENABLED != 0)
+void stack_calibration_start(void);
+void stack_calibration_stop(void);
+#else
+/* The hooks compile to nothing when the calibration is disabled */
+#define stack_calibration_start()   do { } while (0)
+#define stack_calibration_stop()    do { } while (0)
+#endif /* STACK_CALIBRATION_ENABLED */
+
+/* [] END OF FILE */
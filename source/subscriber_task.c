@@ -32,7 +32,12 @@
 #include "string.h"
 
 /* Task header files */
+#include "app_alloc.h"
+#include "backoff.h"
+#include "conn_timing.h"
+#include "mqtt_event_ring.h"
 #include "mqtt_task.h"
+#include "mqtt_topic.h"
 #include "pasco2_config_task.h"
 #include "subscriber_task.h"
 
@@ -49,8 +54,11 @@
 /* Maximum number of retries for MQTT subscribe operation */
 #define MAX_SUBSCRIBE_RETRIES                   (3u)
 
-/* Time interval in milliseconds between MQTT subscribe retries. */
+/* Shortest and longest time interval in milliseconds between MQTT subscribe
+ * retries. The interval grows with random jitter between these limits.
+ */
 #define MQTT_SUBSCRIBE_RETRY_INTERVAL_MS        (1000)
+#define MQTT_SUBSCRIBE_RETRY_MAX_INTERVAL_MS    (30000)
 
 /* The number of MQTT topics to be subscribed to. */
 #define SUBSCRIPTION_COUNT                      (1)
@@ -64,13 +72,16 @@ TaskHandle_t subscriber_task_handle;
 
 /* Handle of the queue holding the commands for the subscriber task */
 QueueHandle_t subscriber_task_q;
+APP_QUEUE_MEMORY(subscriber_task_q, MQTT_SUB_QUEUE_LENGTH, sizeof(subscriber_data_t));
 
-/* Configure the subscription information structure. */
+/* Configure the subscription information structure. The topic is set from
+ * the expanded 'MQTT_SUB_TOPIC' template before each subscription.
+ */
 cy_mqtt_subscribe_info_t subscribe_info =
 {
     .qos = (cy_mqtt_qos_t) MQTT_MESSAGES_QOS,
-    .topic = MQTT_SUB_TOPIC,
-    .topic_len = (sizeof(MQTT_SUB_TOPIC) - 1)
+    .topic = NULL,
+    .topic_len = 0
 };
 
 /******************************************************************************
@@ -79,8 +90,23 @@ cy_mqtt_subscribe_info_t subscribe_info =
 static void subscribe_to_topic(void);
 static void unsubscribe_from_topic(void);
 
+/* Retry delays of the subscribe operation, kept across subscribe requests */
+static backoff_t subscribe_backoff;
+
+/* Failed attempts of the pending subscription and the time of the next one.
+ * The attempts are made by subscriber_retry_step(), so the task or the event
+ * loop keeps handling its queue in between.
+ */
+static bool subscribe_pending = false;
+static uint32_t subscribe_tries = 0;
+static TickType_t next_subscribe_tick;
+
+/* Interned 'MQTT_SUB_TOPIC', its expansion follows the client identifier */
+static mqtt_topic_id_t sub_topic = MQTT_TOPIC_INVALID;
+
 /* Semaphore used to protect message payload */
 SemaphoreHandle_t sem_sub_payload = NULL;
+APP_MUTEX_MEMORY(sem_sub_payload);
 /* Subscribed message paylaod. Maximum with size of 512 byte. */
 char sub_msg_payload[512] = {0};
 
@@ -107,39 +133,96 @@ void subscriber_task(void *pvParameters)
     /* To avoid compiler warnings */
     (void) pvParameters;
 
+    subscriber_init();
+
+    while (true)
+    {
+        /* Wait for commands from other tasks and callbacks, or for the
+         * next subscribe attempt.
+         */
+        if (pdTRUE == xQueueReceive(subscriber_task_q, &subscriber_q_data, subscriber_wait_ticks()))
+        {
+            subscriber_handle(&subscriber_q_data);
+        }
+        subscriber_retry_step();
+    }
+}
+
+/******************************************************************************
+ * Function Name: subscriber_init
+ ******************************************************************************
+ * Summary:
+ *  Function that subscribes to the MQTT topic and creates the message queue
+ *  of the subscriber. Called by the subscriber task, or by the event loop
+ *  task in the APP_EVENT_LOOP_ENABLED build.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void subscriber_init(void)
+{
     /* Initialize semaphore to protect payload */
-    sem_sub_payload = xSemaphoreCreateMutex();
+    sem_sub_payload = APP_MUTEX_CREATE(sem_sub_payload);
     if (sem_sub_payload == NULL)
     {
         printf(" 'sem_sub_payload' semaphore creation failed... Task suspend\n\n");
         vTaskSuspend(NULL);
     }
 
+    /* Use a different seed than the connection backoffs */
+    backoff_init(&subscribe_backoff, MQTT_SUBSCRIBE_RETRY_INTERVAL_MS, MQTT_SUBSCRIBE_RETRY_MAX_INTERVAL_MS,
+                 prng_device_seed() + 1u);
+
+    /* A topic that cannot be interned is a configuration error. */
+    sub_topic = mqtt_topic_intern(MQTT_SUB_TOPIC);
+    if (sub_topic == MQTT_TOPIC_INVALID)
+    {
+        printf("Invalid MQTT subscribe topic '%s'!\n", MQTT_SUB_TOPIC);
+        CY_ASSERT(0);
+    }
+
     /* Subscribe to the specified MQTT topic. */
     subscribe_to_topic();
 
     /* Create a message queue to communicate with other tasks and callbacks. */
-    subscriber_task_q = xQueueCreate(MQTT_SUB_QUEUE_LENGTH, sizeof(subscriber_data_t));
+    subscriber_task_q = APP_QUEUE_CREATE(subscriber_task_q, MQTT_SUB_QUEUE_LENGTH, sizeof(subscriber_data_t));
 
-    while (true)
+    /* Let the MQTT client task continue with the other tasks. */
+    xEventGroupSetBits(mqtt_status_events, MQTT_STATUS_SUBSCRIBER_READY);
+}
+
+/******************************************************************************
+ * Function Name: subscriber_handle
+ ******************************************************************************
+ * Summary:
+ *  Function that performs one command received over the message queue of
+ *  the subscriber.
+ *
+ * Parameters:
+ *  const subscriber_data_t *subscriber_q_data : command
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void subscriber_handle(const subscriber_data_t *subscriber_q_data)
+{
+    switch(subscriber_q_data->cmd)
     {
-        /* Wait for commands from other tasks and callbacks. */
-        if (pdTRUE == xQueueReceive(subscriber_task_q, &subscriber_q_data, portMAX_DELAY))
+        case SUBSCRIBE_TO_TOPIC:
+        {
+            subscribe_to_topic();
+            break;
+        }
+
+        case UNSUBSCRIBE_FROM_TOPIC:
         {
-            switch(subscriber_q_data.cmd)
-            {
-                case SUBSCRIBE_TO_TOPIC:
-                {
-                    subscribe_to_topic();
-                    break;
-                }
-
-                case UNSUBSCRIBE_FROM_TOPIC:
-                {
-                    unsubscribe_from_topic();
-                    break;
-                }
-            }
+            unsubscribe_from_topic();
+            break;
         }
     }
 }
@@ -148,9 +231,10 @@ void subscriber_task(void *pvParameters)
  * Function Name: subscribe_to_topic
  ******************************************************************************
  * Summary:
- *  Function that subscribes to the MQTT topic specified by the macro
- *  'MQTT_SUB_TOPIC'. This operation is retried a maximum of
- *  'MAX_SUBSCRIBE_RETRIES' times with interval of
+ *  Function that starts the subscription to the MQTT topic specified by the
+ *  macro 'MQTT_SUB_TOPIC' and makes the first attempt. A failed attempt is
+ *  retried by subscriber_retry_step() up to 'MAX_SUBSCRIBE_RETRIES' times
+ *  with a jittered interval that grows from
  *  'MQTT_SUBSCRIBE_RETRY_INTERVAL_MS' milliseconds.
  *
  * Parameters:
@@ -162,45 +246,114 @@ void subscriber_task(void *pvParameters)
  ******************************************************************************/
 static void subscribe_to_topic(void)
 {
-    /* Status variable */
-    cy_rslt_t result = CY_RSLT_SUCCESS;
+    /* The topic is expanded again when the client identifier changes. */
+    subscribe_info.topic = mqtt_topic_name(sub_topic);
+    subscribe_info.topic_len = mqtt_topic_len(sub_topic);
+
+    conn_timing_start(CONN_PHASE_SUBSCRIBE);
+    subscribe_pending = true;
+    subscribe_tries = 0;
+    next_subscribe_tick = xTaskGetTickCount();
 
-    /* Command to the MQTT client task */
-    mqtt_task_cmd_t mqtt_task_cmd;
+    subscriber_retry_step();
+}
+
+/******************************************************************************
+ * Function Name: subscriber_wait_ticks
+ ******************************************************************************
+ * Summary:
+ *  Returns the time the subscriber can wait for a new command before the
+ *  next subscribe attempt is due.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  TickType_t : ticks to wait, portMAX_DELAY if no subscription is pending
+ *
+ ******************************************************************************/
+TickType_t subscriber_wait_ticks(void)
+{
+    const TickType_t now_tick = xTaskGetTickCount();
 
-    /* Subscribe with the configured parameters. */
-    for (uint32_t retry_count = 0; retry_count < MAX_SUBSCRIBE_RETRIES; retry_count++)
+    if (!subscribe_pending)
     {
-        result = cy_mqtt_subscribe(mqtt_connection, &subscribe_info, SUBSCRIPTION_COUNT);
-        if (result == CY_RSLT_SUCCESS)
-        {
-            printf("MQTT client subscribed to the topic '%.*s' successfully.\n\n",
-                    subscribe_info.topic_len, subscribe_info.topic);
-            break;
-        }
+        return portMAX_DELAY;
+    }
 
-        vTaskDelay(pdMS_TO_TICKS(MQTT_SUBSCRIBE_RETRY_INTERVAL_MS));
+    return ((int32_t)(next_subscribe_tick - now_tick) > 0) ? (next_subscribe_tick - now_tick) : 0u;
+}
+
+/******************************************************************************
+ * Function Name: subscriber_retry_step
+ ******************************************************************************
+ * Summary:
+ *  Makes the next attempt of the pending subscription if it is due. The
+ *  attempts stop while disconnected, the MQTT client task requests the
+ *  subscription again after the reconnection. The MQTT client task is
+ *  notified when all attempts failed, and requests a new subscription.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void subscriber_retry_step(void)
+{
+    /* Status variable */
+    cy_rslt_t result;
+
+    if (!subscribe_pending || ((int32_t)(next_subscribe_tick - xTaskGetTickCount()) > 0))
+    {
+        return;
     }
 
-    if (result != CY_RSLT_SUCCESS)
+    if (!mqtt_wait_status(MQTT_STATUS_CONNECTED, 0))
     {
-        printf("MQTT Subscribe failed with error 0x%0X after %d retries...\n\n",
-               (int)result, MAX_SUBSCRIBE_RETRIES);
+        printf("MQTT Subscribe postponed, not connected.\n\n");
+        subscribe_pending = false;
+        return;
+    }
 
-        /* Notify the MQTT client task about the subscription failure */
-        mqtt_task_cmd = HANDLE_MQTT_SUBSCRIBE_FAILURE;
-        xQueueSend(mqtt_task_q, &mqtt_task_cmd, portMAX_DELAY);
+    result = cy_mqtt_subscribe(mqtt_connection, &subscribe_info, SUBSCRIPTION_COUNT);
+    if (result == CY_RSLT_SUCCESS)
+    {
+        printf("MQTT client subscribed to the topic '%.*s' successfully.\n\n",
+                subscribe_info.topic_len, subscribe_info.topic);
+        backoff_reset(&subscribe_backoff);
+        subscribe_pending = false;
+
+        /* The SUBACK completes the connection setup. */
+        conn_timing_end(CONN_PHASE_SUBSCRIBE);
+        conn_timing_complete();
+        return;
+    }
+
+    subscribe_tries++;
+    if (subscribe_tries < MAX_SUBSCRIBE_RETRIES)
+    {
+        next_subscribe_tick = xTaskGetTickCount() + pdMS_TO_TICKS(backoff_next_ms(&subscribe_backoff));
+        return;
     }
+
+    printf("MQTT Subscribe failed with error 0x%0X after %d retries...\n\n",
+           (int)result, MAX_SUBSCRIBE_RETRIES);
+    subscribe_pending = false;
+
+    /* Notify the MQTT client task about the subscription failure */
+    (void)mqtt_event_post(HANDLE_MQTT_SUBSCRIBE_FAILURE);
 }
 
 /******************************************************************************
  * Function Name: mqtt_subscription_callback
  ******************************************************************************
  * Summary:
- *  Callback to handle incoming MQTT messages. This callback prints the
- *  contents of the incoming message and informs the subscriber task, via a
- *  message queue, to turn on / turn off the device based on the received
- *  message.
+ *  Callback to handle incoming MQTT messages. This callback copies the
+ *  incoming configuration and requests its parsing. It runs in the context
+ *  of the MQTT library and never blocks: the payload is printed when it is
+ *  parsed, and a message is dropped if its buffer is in use.
  *
  * Parameters:
  *  cy_mqtt_publish_info_t *received_msg_info : Information structure of the
@@ -214,31 +367,29 @@ void mqtt_subscription_callback(cy_mqtt_publish_info_t *received_msg_info)
 {
     /* Received MQTT message */
     const char *received_msg = received_msg_info->payload;
-    int received_msg_len = received_msg_info->payload_len;
-
-    printf("  Subsciber: Incoming MQTT message received:\n"
-           "    Publish topic name: %.*s\n"
-           "    Publish QoS: %d\n"
-           "    Publish payload: %.*s\n\n",
-           received_msg_info->topic_len, received_msg_info->topic,
-           (int) received_msg_info->qos,
-           received_msg_len, (const char *)received_msg);
+    size_t received_msg_len = received_msg_info->payload_len;
 
     if (received_msg_len >= sizeof(sub_msg_payload))
     {
-        printf("Subscribed topic: '%.*s', received message too long. Buffer overflow.\n",
-               received_msg_info->topic_len, received_msg_info->topic);
+        mqtt_event_message_dropped();
         return;
     }
 
-    if (xSemaphoreTake(sem_sub_payload, portMAX_DELAY) == pdTRUE)
+    /* The parser only holds the buffer while copying it, so it is rarely in
+     * use. Drop the message rather than wait.
+     */
+    if (xSemaphoreTake(sem_sub_payload, 0) == pdTRUE)
     {
         memset(sub_msg_payload, '\0', sizeof(sub_msg_payload));
         memcpy(sub_msg_payload, received_msg, received_msg_len);
         xSemaphoreGive(sem_sub_payload);
 
-        /* Notify the pasco2 configuration task. */
-        xTaskNotifyGive(pasco2_config_task_handle);
+        /* Request the pasco2 configuration. */
+        pasco2_config_request();
+    }
+    else
+    {
+        mqtt_event_message_dropped();
     }
 }
 
@@ -258,9 +409,13 @@ void mqtt_subscription_callback(cy_mqtt_publish_info_t *received_msg_info)
  ******************************************************************************/
 static void unsubscribe_from_topic(void)
 {
-    cy_rslt_t result = cy_mqtt_unsubscribe(mqtt_connection,
-                                           (cy_mqtt_unsubscribe_info_t *) &subscribe_info,
-                                           SUBSCRIPTION_COUNT);
+    cy_rslt_t result;
+
+    /* A pending subscription is abandoned */
+    subscribe_pending = false;
+
+    result = cy_mqtt_unsubscribe(mqtt_connection, (cy_mqtt_unsubscribe_info_t *) &subscribe_info,
+                                 SUBSCRIPTION_COUNT);
 
     if (result != CY_RSLT_SUCCESS)
     {
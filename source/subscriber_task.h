@@ -31,13 +31,16 @@
 #include "semphr.h"
 #include "queue.h"
 #include "cy_mqtt_api.h"
+#include "stack_size_config.h"
 
 /*******************************************************************************
 * Macros
 *******************************************************************************/
 /* Task parameters for Subscriber Task. */
 #define SUBSCRIBER_TASK_PRIORITY           (2)
+#ifndef SUBSCRIBER_TASK_STACK_SIZE
 #define SUBSCRIBER_TASK_STACK_SIZE         (1024 * 2)
+#endif
 
 #define MQTT_SUB_QUEUE_LENGTH              (1u)
 #define MQTT_SUB_MSG_MAX_SIZE              (512u)
@@ -69,6 +72,10 @@ extern QueueHandle_t subscriber_task_q;
 * Function Prototypes
 *******************************************************************************/
 void subscriber_task(void *pvParameters);
+void subscriber_init(void);
+void subscriber_handle(const subscriber_data_t *subscriber_q_data);
+TickType_t subscriber_wait_ticks(void);
+void subscriber_retry_step(void);
 void mqtt_subscription_callback(cy_mqtt_publish_info_t *received_msg_info);
 
 /* [] END OF FILE */
@@ -0,0 +1,384 @@
+/******************************************************************************
+ * File Name:   time_sync.c
+ *
+ * Description: This file contains a minimal SNTP client and maintains the
+ *              offset between the monotonic RTOS tick and UTC. The offset is
+ *              corrected for the drift of the local clock on every
+ *              synchronization, so that samples can be time stamped with UTC
+ *              milliseconds between two synchronizations.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS header files */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Middleware libraries */
+#include "cy_secure_sockets.h"
+
+#include "time_sync.h"
+#include "time_sync_config.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Size of an SNTP packet without the optional authentication fields */
+#define SNTP_PACKET_SIZE                 (48u)
+
+/* LI = 0 (no warning), VN = 4, Mode = 3 (client) */
+#define SNTP_CLIENT_REQUEST_FLAGS        (0x23u)
+/* Leap indicator of the first byte, 3 is an unsynchronized server clock */
+#define SNTP_LI_SHIFT                    (6u)
+#define SNTP_LI_ALARM                    (3u)
+/* Mode field of the first byte and the expected server mode */
+#define SNTP_MODE_MASK                   (0x07u)
+#define SNTP_MODE_SERVER                 (4u)
+
+/* Offsets of the fields used in the SNTP packet */
+#define SNTP_STRATUM_OFFSET              (1u)
+#define SNTP_RECEIVE_TIMESTAMP_OFFSET    (32u)
+#define SNTP_TRANSMIT_TIMESTAMP_OFFSET   (40u)
+
+/* Seconds between the NTP epoch (1900) and the Unix epoch (1970) */
+#define NTP_UNIX_EPOCH_OFFSET_S          (2208988800ull)
+
+/* Minimum time between two synchronizations to update the drift estimate.
+ * Shorter intervals are dominated by the network jitter.
+ */
+#define TIME_SYNC_MIN_DRIFT_INTERVAL_MS  (10u * 60u * 1000u)
+
+/* Weight of a new drift measurement: new = old + (measured - old) / 4 */
+#define TIME_SYNC_DRIFT_FILTER_SHIFT     (2)
+
+/*******************************************************************************
+ * Local Variables
+ ******************************************************************************/
+/* UTC and monotonic time in milliseconds at the last synchronization */
+static uint64_t sync_utc_ms;
+static uint64_t sync_mono_ms;
+/* Estimated drift of the local clock against UTC */
+static int32_t drift_ppm;
+static bool time_synced = false;
+/* Latest UTC time returned, it never decreases */
+static uint64_t utc_last_ms;
+
+/* Extension of the 32 bit RTOS tick counter to 64 bit */
+static uint32_t tick_high;
+static TickType_t tick_last;
+
+/******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+static uint64_t sntp_read_timestamp_ms(const uint8_t *timestamp);
+static uint64_t time_sync_extrapolate(uint64_t mono_ms);
+
+/******************************************************************************
+ * Function Name: time_sync_get_mono_ms
+ ******************************************************************************
+ * Summary:
+ *  Returns the monotonic time since boot in milliseconds. The RTOS tick
+ *  counter is extended to 64 bit, so this function must be called at least
+ *  once per tick counter overflow (49 days at 1 kHz), which the periodic
+ *  time synchronization guarantees.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  uint64_t : monotonic time in milliseconds
+ *
+ ******************************************************************************/
+uint64_t time_sync_get_mono_ms(void)
+{
+    uint64_t ticks;
+
+    taskENTER_CRITICAL();
+    TickType_t tick = xTaskGetTickCount();
+    if (tick < tick_last)
+    {
+        tick_high++;
+    }
+    tick_last = tick;
+    ticks = ((uint64_t)tick_high << 32) | tick;
+    taskEXIT_CRITICAL();
+
+    return (ticks * 1000u) / configTICK_RATE_HZ;
+}
+
+/******************************************************************************
+ * Function Name: time_sync_get_utc_ms
+ ******************************************************************************
+ * Summary:
+ *  Returns the current UTC time as milliseconds since the Unix epoch. A
+ *  synchronization that steps the clock back holds the returned time until
+ *  the clock reaches the last returned time again, so the time stamps of
+ *  the samples never decrease.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  uint64_t : UTC time in milliseconds, or 0 if the time was never
+ *             synchronized.
+ *
+ ******************************************************************************/
+uint64_t time_sync_get_utc_ms(void)
+{
+    uint64_t utc_ms = 0;
+    uint64_t mono_ms = time_sync_get_mono_ms();
+
+    taskENTER_CRITICAL();
+    if (time_synced)
+    {
+        utc_ms = time_sync_extrapolate(mono_ms);
+        if (utc_ms < utc_last_ms)
+        {
+            utc_ms = utc_last_ms;
+        }
+        utc_last_ms = utc_ms;
+    }
+    taskEXIT_CRITICAL();
+
+    return utc_ms;
+}
+
+/******************************************************************************
+ * Function Name: time_sync_is_valid
+ ******************************************************************************
+ * Summary:
+ *  Tells whether the UTC time was synchronized at least once.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  bool : true if time_sync_get_utc_ms() returns UTC time
+ *
+ ******************************************************************************/
+bool time_sync_is_valid(void)
+{
+    return time_synced;
+}
+
+/******************************************************************************
+ * Function Name: time_sync_get_drift_ppm
+ ******************************************************************************
+ * Summary:
+ *  Returns the estimated drift of the local clock against UTC.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  int32_t : drift in parts per million, positive if the local clock is slow
+ *
+ ******************************************************************************/
+int32_t time_sync_get_drift_ppm(void)
+{
+    return drift_ppm;
+}
+
+/******************************************************************************
+ * Function Name: time_sync_update
+ ******************************************************************************
+ * Summary:
+ *  Queries the SNTP server 'SNTP_SERVER_ADDRESS' and updates the offset
+ *  between the monotonic time and UTC. The network delay is compensated
+ *  with the round trip time measured on the local clock minus the server
+ *  processing time. Once two synchronizations are far enough apart, the
+ *  remaining error is used to update the drift estimate.
+ *
+ *  This function blocks for up to 'SNTP_RESPONSE_TIMEOUT_MS' and must be
+ *  called from a task that is allowed to do network I/O.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  cy_rslt_t : CY_RSLT_SUCCESS when the time was updated, else an error code
+ *
+ ******************************************************************************/
+cy_rslt_t time_sync_update(void)
+{
+    cy_rslt_t result;
+    cy_socket_t sntp_socket;
+    cy_socket_sockaddr_t server_addr = {.port = SNTP_SERVER_PORT};
+    uint8_t packet[SNTP_PACKET_SIZE];
+    uint32_t timeout_ms = SNTP_RESPONSE_TIMEOUT_MS;
+    uint32_t bytes_transferred = 0;
+    uint32_t addr_len = sizeof(server_addr);
+
+    result = cy_socket_gethostbyname(SNTP_SERVER_ADDRESS, CY_SOCKET_IP_VER_V4, &server_addr.ip_address);
+    if (result != CY_RSLT_SUCCESS)
+    {
+        printf("SNTP: failed to resolve '%s' with error 0x%0X\n", SNTP_SERVER_ADDRESS, (int)result);
+        return result;
+    }
+
+    result = cy_socket_create(CY_SOCKET_DOMAIN_AF_INET, CY_SOCKET_TYPE_DGRAM,
+                              CY_SOCKET_IPPROTO_UDP, &sntp_socket);
+    if (result != CY_RSLT_SUCCESS)
+    {
+        printf("SNTP: socket creation failed with error 0x%0X\n", (int)result);
+        return result;
+    }
+
+    result = cy_socket_setsockopt(sntp_socket, CY_SOCKET_SOL_SOCKET, CY_SOCKET_SO_RCVTIMEO,
+                                  &timeout_ms, sizeof(timeout_ms));
+
+    memset(packet, 0, sizeof(packet));
+    packet[0] = SNTP_CLIENT_REQUEST_FLAGS;
+
+    const uint64_t request_mono_ms = time_sync_get_mono_ms();
+    if (result == CY_RSLT_SUCCESS)
+    {
+        result = cy_socket_sendto(sntp_socket, packet, sizeof(packet), CY_SOCKET_FLAGS_NONE,
+                                  &server_addr, sizeof(server_addr), &bytes_transferred);
+    }
+    if (result == CY_RSLT_SUCCESS)
+    {
+        result = cy_socket_recvfrom(sntp_socket, packet, sizeof(packet), CY_SOCKET_FLAGS_NONE,
+                                    &server_addr, &addr_len, &bytes_transferred);
+    }
+    const uint64_t response_mono_ms = time_sync_get_mono_ms();
+
+    cy_socket_delete(sntp_socket);
+
+    if (result != CY_RSLT_SUCCESS)
+    {
+        printf("SNTP: request failed with error 0x%0X\n", (int)result);
+        return result;
+    }
+
+    /* Reject short packets, non-server responses, Kiss-o'-Death packets and
+     * servers whose own clock is not synchronized
+     */
+    if ((bytes_transferred < SNTP_PACKET_SIZE) ||
+        ((packet[0] & SNTP_MODE_MASK) != SNTP_MODE_SERVER) ||
+        ((packet[0] >> SNTP_LI_SHIFT) == SNTP_LI_ALARM) ||
+        (packet[SNTP_STRATUM_OFFSET] == 0u))
+    {
+        printf("SNTP: invalid response from server\n");
+        return TIME_SYNC_RSLT_ERR_INVALID_RESPONSE;
+    }
+
+    const uint64_t server_rx_ms = sntp_read_timestamp_ms(&packet[SNTP_RECEIVE_TIMESTAMP_OFFSET]);
+    const uint64_t server_tx_ms = sntp_read_timestamp_ms(&packet[SNTP_TRANSMIT_TIMESTAMP_OFFSET]);
+
+    /* A zero or pre-1970 timestamp is not a time */
+    if ((server_rx_ms == 0u) || (server_tx_ms == 0u))
+    {
+        printf("SNTP: invalid time stamp from server\n");
+        return TIME_SYNC_RSLT_ERR_INVALID_RESPONSE;
+    }
+
+    const uint64_t local_rtt_ms = response_mono_ms - request_mono_ms;
+    const uint64_t server_proc_ms = (server_tx_ms > server_rx_ms) ? (server_tx_ms - server_rx_ms) : 0u;
+    const uint64_t network_delay_ms = (local_rtt_ms > server_proc_ms) ? (local_rtt_ms - server_proc_ms) : 0u;
+
+    /* UTC at the time the response was received */
+    const uint64_t utc_ms = server_tx_ms + (network_delay_ms / 2u);
+
+    taskENTER_CRITICAL();
+    if (time_synced && ((response_mono_ms - sync_mono_ms) >= TIME_SYNC_MIN_DRIFT_INTERVAL_MS))
+    {
+        /* Error left after applying the current drift estimate */
+        const int64_t error_ms = (int64_t)(utc_ms - time_sync_extrapolate(response_mono_ms));
+        const int64_t elapsed_ms = (int64_t)(response_mono_ms - sync_mono_ms);
+        int64_t new_drift_ppm = drift_ppm + (((error_ms * 1000000) / elapsed_ms) >> TIME_SYNC_DRIFT_FILTER_SHIFT);
+
+        if (new_drift_ppm > TIME_SYNC_MAX_DRIFT_PPM)
+        {
+            new_drift_ppm = TIME_SYNC_MAX_DRIFT_PPM;
+        }
+        else if (new_drift_ppm < -TIME_SYNC_MAX_DRIFT_PPM)
+        {
+            new_drift_ppm = -TIME_SYNC_MAX_DRIFT_PPM;
+        }
+        drift_ppm = (int32_t)new_drift_ppm;
+    }
+    sync_utc_ms = utc_ms;
+    sync_mono_ms = response_mono_ms;
+    time_synced = true;
+    taskEXIT_CRITICAL();
+
+    printf("SNTP: time synchronized, UTC %lu s, round trip %u ms, drift %d ppm\n",
+           (unsigned long)(utc_ms / 1000u), (unsigned int)local_rtt_ms, (int)drift_ppm);
+
+    return CY_RSLT_SUCCESS;
+}
+
+/******************************************************************************
+ * Function Name: time_sync_extrapolate
+ ******************************************************************************
+ * Summary:
+ *  Converts a monotonic time to UTC using the last synchronization point and
+ *  the drift estimate. Must be called inside a critical section.
+ *
+ * Parameters:
+ *  uint64_t mono_ms : monotonic time in milliseconds
+ *
+ * Return:
+ *  uint64_t : UTC time in milliseconds
+ *
+ ******************************************************************************/
+static uint64_t time_sync_extrapolate(uint64_t mono_ms)
+{
+    const int64_t elapsed_ms = (int64_t)(mono_ms - sync_mono_ms);
+
+    return sync_utc_ms + elapsed_ms + ((elapsed_ms * drift_ppm) / 1000000);
+}
+
+/******************************************************************************
+ * Function Name: sntp_read_timestamp_ms
+ ******************************************************************************
+ * Summary:
+ *  Converts a big endian 64 bit NTP timestamp (32 bit seconds since 1900 and
+ *  32 bit fraction) to milliseconds since the Unix epoch.
+ *
+ * Parameters:
+ *  const uint8_t *timestamp : pointer to the timestamp in the SNTP packet
+ *
+ * Return:
+ *  uint64_t : milliseconds since the Unix epoch, 0 for a timestamp before
+ *             the Unix epoch, which includes the unset timestamp 0
+ *
+ ******************************************************************************/
+static uint64_t sntp_read_timestamp_ms(const uint8_t *timestamp)
+{
+    const uint32_t seconds = ((uint32_t)timestamp[0] << 24) | ((uint32_t)timestamp[1] << 16) |
+                             ((uint32_t)timestamp[2] << 8) | (uint32_t)timestamp[3];
+    const uint32_t fraction = ((uint32_t)timestamp[4] << 24) | ((uint32_t)timestamp[5] << 16) |
+                              ((uint32_t)timestamp[6] << 8) | (uint32_t)timestamp[7];
+
+    if (seconds < NTP_UNIX_EPOCH_OFFSET_S)
+    {
+        return 0u;
+    }
+
+    return ((seconds - NTP_UNIX_EPOCH_OFFSET_S) * 1000u) + (((uint64_t)fraction * 1000u) >> 32);
+}
+
+/* [] END OF FILE */
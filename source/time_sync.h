@@ -0,0 +1,51 @@
+/******************************************************************************
+ * File Name:   time_sync.h
+ *
+ * Description: This file is the public interface of time_sync.c
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "cy_result.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Returned by time_sync_update() for a response that is not a valid time,
+ * a code of this application in the middleware module range
+ */
+#define TIME_SYNC_RSLT_ERR_INVALID_RESPONSE \
+    CY_RSLT_CREATE(CY_RSLT_TYPE_ERROR, CY_RSLT_MODULE_MIDDLEWARE_BASE, 0x5401u)
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+cy_rslt_t time_sync_update(void);
+bool time_sync_is_valid(void);
+uint64_t time_sync_get_mono_ms(void);
+uint64_t time_sync_get_utc_ms(void);
+int32_t time_sync_get_drift_ppm(void);
+
+/* [] END OF FILE */
@@ -0,0 +1,161 @@
+/******************************************************************************
+ * File Name:   wifi_rejoin.c
+ *
+ * Description: This file keeps the BSSID, channel and DHCP lease of the last
+ *              Wi-Fi connection, so that a reconnect can rejoin the same AP without
+ *              a scan of all channels and optionally without DHCP.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "time_sync.h"
+#include "wifi_config.h"
+#include "wifi_rejoin.h"
+
+/*******************************************************************************
+ * Typedefines
+ ******************************************************************************/
+/* AP and DHCP lease of the last Wi-Fi connection */
+typedef struct
+{
+    cy_wcm_mac_t bssid;
+    uint8_t channel;
+    cy_wcm_ip_setting_t lease;
+    uint64_t leased_ms;         /* Monotonic time the lease was obtained */
+    bool lease_valid;
+    bool valid;
+} wifi_rejoin_cache_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static wifi_rejoin_cache_t rejoin_cache;
+
+/*******************************************************************************
+ * Function Name: wifi_rejoin_prepare
+ *******************************************************************************
+ * Summary:
+ *   Adds the BSSID of the last AP to the connection parameters, and the last
+ *   DHCP lease if WIFI_FAST_REJOIN_REUSE_LEASE is set and the lease is not
+ *   too old. The WCM then joins that AP directly. The channel is only
+ *   logged, the WCM finds it with a scan that is limited to the BSSID.
+ *
+ * Parameters:
+ *   connect_param: connection parameters with the SSID and credentials set
+ *   ip_settings: storage of the reused lease, must be valid until connected
+ *
+ * Return:
+ *   bool: true if the parameters were changed for a fast rejoin
+ ******************************************************************************/
+bool wifi_rejoin_prepare(cy_wcm_connect_params_t *connect_param, cy_wcm_ip_setting_t *ip_settings)
+{
+    if (!WIFI_FAST_REJOIN_ENABLED || !rejoin_cache.valid)
+    {
+        return false;
+    }
+
+    memcpy(connect_param->BSSID, rejoin_cache.bssid, sizeof(connect_param->BSSID));
+    printf("Rejoining AP %02X:%02X:%02X:%02X:%02X:%02X on channel %u",
+           rejoin_cache.bssid[0], rejoin_cache.bssid[1], rejoin_cache.bssid[2],
+           rejoin_cache.bssid[3], rejoin_cache.bssid[4], rejoin_cache.bssid[5],
+           (unsigned int)rejoin_cache.channel);
+
+#if WIFI_FAST_REJOIN_REUSE_LEASE
+    if (rejoin_cache.lease_valid &&
+        ((time_sync_get_mono_ms() - rejoin_cache.leased_ms) < WIFI_FAST_REJOIN_LEASE_MAX_AGE_MS))
+    {
+        *ip_settings = rejoin_cache.lease;
+        connect_param->static_ip_settings = ip_settings;
+        printf(" with the last DHCP lease");
+    }
+#else
+    (void)ip_settings;
+#endif /* WIFI_FAST_REJOIN_REUSE_LEASE */
+
+    printf("\n");
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: wifi_rejoin_store
+ *******************************************************************************
+ * Summary:
+ *   Stores the AP and the IP settings of a successful Wi-Fi connection for
+ *   the next rejoin.
+ *
+ * Parameters:
+ *   ip_address: address assigned to the connection
+ *   leased: true if the address was obtained by DHCP, false if a stored
+ *           lease was reused, which keeps the time of that lease
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void wifi_rejoin_store(const cy_wcm_ip_address_t *ip_address, bool leased)
+{
+    cy_wcm_associated_ap_info_t ap_info;
+
+    if (CY_RSLT_SUCCESS != cy_wcm_get_associated_ap_info(&ap_info))
+    {
+        rejoin_cache.valid = false;
+        return;
+    }
+
+    memcpy(rejoin_cache.bssid, ap_info.BSSID, sizeof(rejoin_cache.bssid));
+    rejoin_cache.channel = ap_info.channel;
+
+    if (leased)
+    {
+        /* Without a complete lease, only the AP is rejoined directly */
+        rejoin_cache.lease.ip_address = *ip_address;
+        rejoin_cache.leased_ms = time_sync_get_mono_ms();
+        rejoin_cache.lease_valid =
+            (CY_RSLT_SUCCESS == cy_wcm_get_gateway_ip_address(CY_WCM_INTERFACE_TYPE_STA,
+                                                              &rejoin_cache.lease.gateway, 1)) &&
+            (CY_RSLT_SUCCESS == cy_wcm_get_ip_netmask(CY_WCM_INTERFACE_TYPE_STA,
+                                                      &rejoin_cache.lease.netmask, 1));
+    }
+
+    rejoin_cache.valid = true;
+}
+
+/*******************************************************************************
+ * Function Name: wifi_rejoin_invalidate
+ *******************************************************************************
+ * Summary:
+ *   Forgets the last AP and lease after a failed rejoin, so that the next
+ *   connection searches the SSID and runs DHCP again.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void wifi_rejoin_invalidate(void)
+{
+    rejoin_cache.valid = false;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,41 @@
+/******************************************************************************
+ * File Name:   wifi_rejoin.h
+ *
+ * Description: This file contains the function prototypes of the fast Wi-Fi
+ *              rejoin.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2021 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+#include "cy_wcm.h"
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+bool wifi_rejoin_prepare(cy_wcm_connect_params_t *connect_param, cy_wcm_ip_setting_t *ip_settings);
+void wifi_rejoin_store(const cy_wcm_ip_address_t *ip_address, bool leased);
+void wifi_rejoin_invalidate(void);
+
+/* [] END OF FILE */